@@ -5,10 +5,31 @@ struct Architecture {
   virtual ~Architecture() {
   }
 
+  //returns the paths that an architecture file is looked for in, by order of precedence
+  //the directories are found once, as Path::userData() is not thread-safe (see --serve)
+  static auto locations(const string& filename) -> string_vector {
+    static const string userData = Path::userData();
+    static const string program = Path::program();
+    return {{userData, "bass/architectures/", filename}, {program, "architectures/", filename}};
+  }
+
+  //returns the path of an architecture file, or an empty string if none exists
+  static auto locate(const string& filename) -> string {
+    for(auto& location : locations(filename)) {
+      if(file::exists(location)) return location;
+    }
+    return {};
+  }
+
   virtual auto assemble(const string& statement) -> bool {
     return false;
   }
 
+  //false while part of a byte is pending, to be completed by the next instruction
+  virtual auto aligned() const -> bool {
+    return true;
+  }
+
   //
 
   auto pc() const -> uint {
@@ -0,0 +1,204 @@
+//writes the C++ source of a Native architecture for each table, along with the list of builtins.
+//the generated source is included by native.cpp, unless bass is built with BASS_BOOTSTRAP.
+struct Native::Generator {
+  auto generate(const string& location) -> bool;
+  auto opcode(const Table::Opcode& opcode, uint id) -> bool;
+  auto sequence(const vector<uint>& candidates, const string& indent) -> void;
+
+  static auto literal(const string& text) -> string;
+  static auto character(char c) -> string;
+
+  string output;
+  string_vector names;    //name of each architecture
+  string_vector classes;  //class of each architecture
+  const Table::Definition* definition = nullptr;  //table being generated
+};
+
+auto Native::generate(const string& location, const string_vector& tables) -> bool {
+  Generator generator;
+  auto& output = generator.output;
+  output.append("//generated by bass-untech --generate-arch; do not edit\n");
+
+  for(auto& table : tables) {
+    if(!generator.generate(table)) {
+      print(stderr, "error: unable to generate architecture: ", table, "\n");
+      return false;
+    }
+  }
+
+  output.append("\n");
+  output.append("auto Native::builtins() -> array_view<Builtin> {\n");
+  output.append("  static const Builtin list[] = {\n");
+  for(uint n : range(generator.names.size())) {
+    auto& name = generator.names[n];
+    auto& type = generator.classes[n];
+    output.append("    {", Generator::literal(name), ", ", type, "::source, [](Bass& self) -> Native* { return new ", type, "{self}; }},\n");
+  }
+  output.append("  };\n");
+  output.append("  return {list, ", generator.names.size(), "};\n");
+  output.append("}\n");
+
+  return file::write(location, output);
+}
+
+auto Native::Generator::generate(const string& location) -> bool {
+  if(!file::exists(location)) return false;
+  auto text = string::read(location);
+  auto name = Location::prefix(location);
+  string type = {"Native_", name};
+  type.transform("-.", "__");
+
+  Table::Definition definition;
+  Table::parseTable(definition, text);
+  this->definition = &definition;
+  names.append(name);
+  classes.append(type);
+
+  output.append("\n");
+  output.append("//", Location::file(location), "\n");
+  output.append("struct ", type, " : Native {\n");
+  output.append("  static constexpr const char* source = ", literal(text), ";\n");
+  output.append("\n");
+  output.append("  ", type, "(Bass& self) : Native(self, builtins()[", names.size() - 1, "]) {\n");
+  if(definition.endian) {
+    output.append("    setEndian(Bass::Endian::", definition.endian() == Bass::Endian::LSB ? "LSB" : "MSB", ");\n");
+  }
+  output.append("  }\n");
+
+  //statements are dispatched on the hash of their mnemonic, and then on the first character of their operand
+  output.append("\n");
+  output.append("  auto dispatch(const string& s, uint length, char first, uint pc) -> bool override {\n");
+  output.append("    switch(hash(s.data(), length)) {\n");
+  auto mnemonics = Table::mnemonicNames(definition);
+  vector<uint> hashes;
+  for(auto& mnemonic : mnemonics) {
+    if(!hashes.find(mnemonic.hash())) hashes.append(mnemonic.hash());
+  }
+  for(auto hash : hashes) {
+    output.append("    case 0x", hex(hash, 8L), "u:\n");
+    for(auto& mnemonicName : mnemonics) {
+      if(mnemonicName.hash() != hash) continue;
+      auto& mnemonic = definition.mnemonics.find({mnemonicName})();
+      output.append("      if(equal(s, length, ", literal(mnemonicName), ", ", mnemonicName.size(), ")) {\n");
+      if(mnemonic.shapes) {
+        output.append("        switch(first) {\n");
+        for(auto& shape : mnemonic.shapes) {
+          output.append("        case ", character(shape.first), ":\n");
+          sequence(shape.opcodes, "          ");
+          output.append("          return false;\n");
+        }
+        output.append("        }\n");
+      }
+      sequence(mnemonic.opcodes, "        ");
+      output.append("        return false;\n");
+      output.append("      }\n");
+    }
+    output.append("      break;\n");
+  }
+  output.append("    }\n");
+  sequence({}, "    ");
+  output.append("    return false;\n");
+  output.append("  }\n");
+
+  for(uint id : range(definition.table.size())) {
+    if(!opcode(definition.table[id], id)) return false;
+  }
+
+  output.append("};\n");
+  return true;
+}
+
+//each opcode is matched and encoded exactly as Table::assembleOpcode() would
+auto Native::Generator::opcode(const Table::Opcode& opcode, uint id) -> bool {
+  using Format = Table::Format;
+  uint wildcards = opcode.number.size();
+  if(wildcards > 26) return false;
+  for(auto& format : opcode.format) {
+    if(format.type != Format::Type::Static && format.argument >= wildcards) return false;
+  }
+
+  output.append("\n");
+  output.append("  //", opcode.pattern, "\n");
+  output.append("  auto opcode", id, "(const string& s, uint pc) -> bool {\n");
+  if(!opcode.prefix) {
+    output.append("    return false;\n");
+    output.append("  }\n");
+    return true;
+  }
+
+  auto& first = opcode.prefix[0];
+  output.append("    if(!prefix(s, ", literal(first.text), ", ", first.size, ")) return false;\n");
+  if(!wildcards) {
+    output.append("    if(s.size() != ", first.size, ") return false;\n");
+  } else {
+    output.append("    uint offset = ", first.size, ";\n");
+  }
+  for(uint n : range(wildcards)) {
+    if(n + 1 < opcode.prefix.size()) {
+      auto& next = opcode.prefix[n + 1];
+      string capture = n + 1 == wildcards ? "suffix" : "find";
+      output.append("    if(!", capture, "(s, offset, ", n, ", ", literal(next.text), ", ", next.size, ")) return false;\n");
+    } else {
+      output.append("    rest(s, offset, ", n, ");\n");
+    }
+  }
+
+  for(auto& format : opcode.format) {
+    if(format.type != Format::Type::Absolute || format.match == Format::Match::Weak) continue;
+    bool exact = format.match == Format::Match::Exact;
+    uint bits = opcode.number[format.argument].bits;
+    output.append("    if(!check(s, ", format.argument, ", ", bits, ", ", exact ? "true" : "false", ")) return false;\n");
+  }
+
+  for(auto& format : opcode.format) {
+    switch(format.type) {
+    case Format::Type::Static:
+      output.append("    writeBits(0x", hex(format.data), ", ", format.bits, ");\n");
+      break;
+    case Format::Type::Absolute:
+      output.append("    absolute(s, ", format.argument, ", ", opcode.number[format.argument].bits, ");\n");
+      break;
+    case Format::Type::Relative:
+      output.append("    relative(s, ", format.argument, ", ", opcode.number[format.argument].bits, ", ", format.displacement, ", pc);\n");
+      break;
+    case Format::Type::Repeat:
+      output.append("    repeat(s, ", format.argument, ", 0x", hex(format.data), ", ", opcode.number[format.argument].bits, ");\n");
+      break;
+    }
+  }
+
+  output.append("    return true;\n");
+  output.append("  }\n");
+  return true;
+}
+
+//opcodes are tried in table order, merging in any opcodes with wildcard mnemonics; as Table::assemble()
+auto Native::Generator::sequence(const vector<uint>& candidates, const string& indent) -> void {
+  uint x = 0, y = 0;
+  auto& wildcards = definition->wildcards;
+  uint xs = candidates.size(), ys = wildcards.size();
+  while(x < xs || y < ys) {
+    uint id = y >= ys || (x < xs && candidates[x] < wildcards[y]) ? candidates[x++] : wildcards[y++];
+    output.append(indent, "if(opcode", id, "(s, pc)) return true;\n");
+  }
+}
+
+auto Native::Generator::literal(const string& text) -> string {
+  string result = "\"";
+  for(char c : text) {
+    if(c == '\n') result.append("\\n\"\n    \"");
+    else if(c == '\t') result.append("\\t");
+    else if(c == '\\' || c == '\"') result.append("\\", c);
+    else if((uint8_t)c < 0x20 || (uint8_t)c >= 0x7f) result.append("\\", octal((uint8_t)c, 3L));
+    else result.append(c);
+  }
+  result.append("\"");
+  return result;
+}
+
+auto Native::Generator::character(char c) -> string {
+  if(c == 0) return "0";
+  if(c == '\\' || c == '\'') return {"'\\", c, "'"};
+  if((uint8_t)c < 0x20 || (uint8_t)c >= 0x7f) return {"(char)0x", hex((uint8_t)c, 2L)};
+  return {"'", c, "'"};
+}
@@ -0,0 +1,177 @@
+#include "generate.cpp"
+#include "verify.cpp"
+
+#if defined(BASS_BOOTSTRAP)
+//the bootstrap build generates the built-in architectures, and so has none of its own
+auto Native::builtins() -> array_view<Builtin> {
+  return {};
+}
+#else
+#include "../../obj/native.hpp"
+#endif
+
+//built-in architectures are used unless their table file has been replaced with a different one.
+//the file is compared again whenever it changes, as it may be edited while bass is running (see --serve).
+auto Native::create(Bass& self, const string& name, const string& location) -> Native* {
+  for(auto& builtin : builtins()) {
+    if(name != builtin.name) continue;
+    if(location && !original(builtin, location)) return nullptr;
+    return builtin.create(self);
+  }
+  return nullptr;
+}
+
+//returns true if the file at location holds the table that builtin was generated from
+auto Native::original(const Builtin& builtin, const string& location) -> bool {
+  struct Compared {
+    Compared() {}
+    Compared(const string& location) : location(location) {}
+
+    auto hash() const -> uint { return location.hash(); }
+    auto operator==(const Compared& source) const -> bool { return location == source.location; }
+
+    string location;
+    uint64_t modified;
+    uint64_t size;
+    bool original;
+  };
+  static mutex lock;
+  static hashset<Compared> compared;
+
+  uint64_t modified = inode::timestamp(location);
+  uint64_t size = file::size(location);
+  lock_guard<mutex> guard(lock);
+  if(auto cached = compared.find({location})) {
+    if(cached().modified == modified && cached().size == size) return cached().original;
+    compared.remove({location});
+  }
+
+  //the cache keeps its own copy of location, as the caller's is released after the lock is
+  Compared result{string{string_view{location}}};
+  result.modified = modified;
+  result.size = size;
+  result.original = size == strlen(builtin.source) && string::read(location) == builtin.source;
+  compared.insert(result);
+  return result.original;
+}
+
+Native::Native(Bass& self, const Builtin& builtin) : Architecture(self), builtin(builtin) {
+  bitval = 0;
+  bitpos = 0;
+}
+
+auto Native::assemble(const string& statement) -> bool {
+  if(instrumented) return instrumented->assemble(statement);
+
+  //instrument modifies the table, which is then interpreted by a Table in place of this architecture
+  if(statement.match("instrument \"*\"")) {
+    definition = new Table::Definition;
+    Table::parseTable(definition(), builtin.source);
+    auto endian = Architecture::endian();
+    instrumented = new Table{self, definition()};
+    instrumented->bitval = bitval;
+    instrumented->bitpos = bitpos;
+    setEndian(endian);
+    return instrumented->assemble(statement);
+  }
+
+  uint length = 0;
+  while(statement[length] && statement[length] != ' ') length++;
+  char first = statement[length] ? statement[length + 1] : 0;
+  return dispatch(statement, length, first, pc());
+}
+
+auto Native::aligned() const -> bool {
+  if(instrumented) return instrumented->aligned();
+  return bitpos == 0;
+}
+
+//equivalent to string::hash(), which the generator uses to label each mnemonic
+auto Native::hash(const char* p, uint length) -> uint {
+  uint result = 5381;
+  while(length--) result = (result << 5) + result + *p++;
+  return result;
+}
+
+auto Native::equal(const string& statement, uint length, const char* name, uint size) -> bool {
+  return length == size && !memory::compare(statement.data(), name, size);
+}
+
+auto Native::prefix(const string& statement, const char* text, uint size) -> bool {
+  return statement.size() >= size && !memory::compare(statement.data(), text, size);
+}
+
+//captures the argument ending where the final literal of the pattern begins
+auto Native::suffix(const string& statement, uint& offset, uint index, const char* text, uint size) -> bool {
+  if(statement.size() < offset + size) return false;
+  uint position = statement.size() - size;
+  if(memory::compare(statement.data() + position, text, size)) return false;
+  arguments[index] = {offset, position - offset, false};
+  offset = position + size;
+  return true;
+}
+
+//captures the argument ending at the first occurrence of the following literal
+auto Native::find(const string& statement, uint& offset, uint index, const char* text, uint size) -> bool {
+  uint position = offset;
+  if(size) {
+    auto found = statement.findFrom(offset, text);
+    if(!found) return false;
+    position = offset + found();
+  }
+  arguments[index] = {offset, position - offset, false};
+  offset = position + size;
+  return true;
+}
+
+//captures the remainder of the statement, when the pattern ends with a wildcard
+auto Native::rest(const string& statement, uint& offset, uint index) -> void {
+  arguments[index] = {offset, statement.size() - offset, false};
+  offset = statement.size();
+}
+
+auto Native::check(const string& statement, uint index, uint bits, bool exact) -> bool {
+  auto& argument = arguments[index];
+  uint length = 0;
+  if(!argument.prefixed) {
+    length = Table::bitLength(statement.data() + argument.offset, argument.length);
+    argument.prefixed = argument.length && strchr("<>^?:", statement[argument.offset]);
+  }
+  return length == bits || (!exact && length == 0);
+}
+
+auto Native::argument(const string& statement, uint index) const -> string {
+  auto& argument = arguments[index];
+  string text = slice(statement, argument.offset, argument.length);
+  if(argument.prefixed) text.get()[0] = ' ';
+  return text;
+}
+
+auto Native::absolute(const string& statement, uint index, uint bits) -> void {
+  uint data = evaluate(argument(statement, index), Bass::Evaluation::Lax);
+  writeBits(data, bits);
+}
+
+auto Native::relative(const string& statement, uint index, uint bits, int displacement, uint pc) -> void {
+  int data = evaluate(argument(statement, index), Bass::Evaluation::Lax) - (pc + displacement);
+  int min = -(1 << (bits - 1)), max = +(1 << (bits - 1)) - 1;
+  if(data < min || data > max) error("branch out of bounds");
+  writeBits(data, bits);
+}
+
+auto Native::repeat(const string& statement, uint index, uint data, uint bits) -> void {
+  uint count = evaluate(argument(statement, index), Bass::Evaluation::Lax);
+  for(uint n : range(count)) writeBits(data, bits);
+}
+
+auto Native::writeBits(uint64_t data, uint length) -> void {
+  bitval <<= length;
+  bitval |= data;
+  bitpos += length;
+
+  while(bitpos >= 8) {
+    write(bitval);
+    bitval >>= 8;
+    bitpos -= 8;
+  }
+}
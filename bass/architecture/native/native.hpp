@@ -0,0 +1,50 @@
+//architectures generated from the shipped tables by --generate-arch, and compiled into bass.
+//each opcode is compiled into a function, and statements are dispatched on their mnemonic and
+//the first character of their operand. opcodes are tried in the same order as Table tries them.
+struct Native : Architecture {
+  struct Builtin {
+    const char* name;
+    const char* source;  //text of the table the architecture was generated from
+    auto (*create)(Bass& self) -> Native*;
+  };
+
+  static auto builtins() -> array_view<Builtin>;
+  static auto create(Bass& self, const string& name, const string& location) -> Native*;
+  static auto generate(const string& location, const string_vector& tables) -> bool;
+  static auto verify(const string& name) -> bool;
+
+  Native(Bass& self, const Builtin& builtin);
+  auto assemble(const string& statement) -> bool override;
+  auto aligned() const -> bool override;
+
+protected:
+  virtual auto dispatch(const string& statement, uint length, char first, uint pc) -> bool = 0;
+
+  static auto original(const Builtin& builtin, const string& location) -> bool;
+  static auto hash(const char* text, uint length) -> uint;
+  static auto equal(const string& statement, uint length, const char* name, uint size) -> bool;
+
+  //pattern matching; mirrors Table::match()
+  auto prefix(const string& statement, const char* text, uint size) -> bool;
+  auto suffix(const string& statement, uint& offset, uint index, const char* text, uint size) -> bool;
+  auto find(const string& statement, uint& offset, uint index, const char* text, uint size) -> bool;
+  auto rest(const string& statement, uint& offset, uint index) -> void;
+  auto check(const string& statement, uint index, uint bits, bool exact) -> bool;
+  auto argument(const string& statement, uint index) const -> string;
+
+  //opcode encoding; mirrors Table::assembleOpcode()
+  auto absolute(const string& statement, uint index, uint bits) -> void;
+  auto relative(const string& statement, uint index, uint bits, int displacement, uint pc) -> void;
+  auto repeat(const string& statement, uint index, uint data, uint bits) -> void;
+  auto writeBits(uint64_t data, uint bits) -> void;
+
+private:
+  struct Generator;
+  struct Verifier;
+
+  const Builtin& builtin;
+  shared_pointer<Table::Definition> definition;  //parsed from builtin.source, once instrumented
+  unique_pointer<Table> instrumented;  //assembles every statement once the table is modified
+  Table::Argument arguments[26];  //arguments of the most recent match; one per wildcard
+  uint64_t bitval, bitpos;
+};
@@ -0,0 +1,121 @@
+//assembles statements synthesized from every opcode pattern of a table with both the built-in
+//architecture and the table interpreter, and compares the bytes that each of them writes
+struct Native::Verifier : Bass {
+  struct Result {
+    auto operator==(const Result& source) const -> bool {
+      return accepted == source.accepted && failed == source.failed && aligned == source.aligned && data == source.data;
+    }
+    auto operator!=(const Result& source) const -> bool { return !operator==(source); }
+
+    bool accepted = false;
+    bool failed = false;  //raised an error
+    bool aligned = true;
+    vector<uint8_t> data;
+  };
+
+  Verifier();
+  auto run(Architecture& architecture, const string& statement) -> Result;
+  auto statements(const Table::Opcode& opcode) -> string_vector;
+  auto sample(uint bits, bool relative, uint kind) -> string;
+};
+
+auto Native::verify(const string& name) -> bool {
+  for(auto& builtin : builtins()) {
+    if(name != builtin.name) continue;
+
+    Table::Definition definition;
+    Table::parseTable(definition, builtin.source);
+    Verifier verifier;
+    uint count = 0, mismatches = 0;
+    for(auto& opcode : definition.table) {
+      for(auto& statement : verifier.statements(opcode)) {
+        Table table{verifier, definition};
+        unique_pointer<Native> native = builtin.create(verifier);
+        auto expected = verifier.run(table, statement);
+        auto actual = verifier.run(native(), statement);
+        count++;
+        if(actual != expected) {
+          print(stderr, "error: ", name, ": built-in architecture differs from table: ", statement, "\n");
+          mismatches++;
+        }
+      }
+    }
+
+    if(mismatches) return false;
+    print(name, ": ", count, " statements verified\n");
+    return true;
+  }
+
+  print(stderr, "error: no built-in architecture: ", name, "\n");
+  return false;
+}
+
+//statements are assembled as the query phase would, so that their output is kept in emissionData
+Native::Verifier::Verifier() {
+  quiet = true;  //statements are expected to raise errors whenever the table does
+  initialize();
+  frames.append({0, false});
+  phase = Phase::Query;
+}
+
+auto Native::Verifier::run(Architecture& architecture, const string& statement) -> Result {
+  Result result;
+  replayable = true;
+  emissions.reset();
+  emissionData.reset();
+  origin = 0;
+  base = 0;
+  try {
+    result.accepted = architecture.assemble(statement);
+  } catch(...) {
+    result.failed = true;
+  }
+  result.aligned = architecture.aligned();
+  result.data = emissionData;
+  return result;
+}
+
+//each wildcard of the pattern is replaced with operands of several shapes and sizes,
+//so that statements are also matched by opcodes other than the one they were made from
+auto Native::Verifier::statements(const Table::Opcode& opcode) -> string_vector {
+  string_vector statements;
+  if(!opcode.prefix) return statements;
+
+  vector<bool> relative;
+  relative.resize(opcode.number.size());
+  for(auto& format : opcode.format) {
+    if(format.type == Table::Format::Type::Relative) relative[format.argument] = true;
+  }
+
+  for(uint kind : range(4)) {
+    string statement = opcode.prefix[0].text;
+    for(uint n : range(opcode.number.size())) {
+      statement.append(sample(opcode.number[n].bits, relative[n], kind));
+      if(n + 1 < opcode.prefix.size()) statement.append(opcode.prefix[n + 1].text);
+    }
+    if(!statements.find(statement)) statements.append(statement);
+  }
+  return statements;
+}
+
+auto Native::Verifier::sample(uint bits, bool relative, uint kind) -> string {
+  if(relative) return string_vector{"1", "0", "-2", "$3"}[kind];
+
+  auto digits = [&](uint bits) -> string {
+    if(bits % 4) return slice("%1011010011010110101100101011010110101101001101011010110010101101", 0, bits + 1);
+    return slice("$123456789abcdef0123456789abcdef", 0, bits / 4 + 1);
+  };
+
+  switch(kind) {
+  case 0: return digits(bits);
+  case 1: return "18";
+  case 2:
+    if(bits ==  8) return "<18";
+    if(bits == 16) return ">18";
+    if(bits == 24) return "^18";
+    if(bits == 32) return "?18";
+    if(bits == 64) return ":18";
+    return {bits % 4 ? "0b" : "0x", slice(digits(bits), 1)};
+  default: return digits(bits + 4);  //wider than the pattern accepts
+  }
+}
@@ -0,0 +1,69 @@
+//bass-untech architecture plugin interface
+//
+//a plugin is a shared object named after its architecture (eg dsp.so, or dsp.dll or dsp.dylib),
+//placed alongside the .arch tables. "architecture dsp" loads it in place of dsp.arch.
+//the interface is plain C, so that plugins do not depend upon the compiler or version of bass.
+
+#pragma once
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+  #define BASS_EXPORT __declspec(dllexport)
+#else
+  #define BASS_EXPORT __attribute__((visibility("default")))
+#endif
+
+#define BASS_ARCHITECTURE_VERSION 1
+
+//results of bass_architecture.assemble
+#define BASS_DECLINED   0  //statement is not an instruction of this architecture
+#define BASS_ASSEMBLED  1
+#define BASS_FAILED    -1  //a host callback reported failure
+
+//modes of bass_host.evaluate
+#define BASS_EVALUATE_STRICT 0  //forward references are an error
+#define BASS_EVALUATE_LAX    1  //forward references are resolved by a later pass
+
+//endian modes of bass_host.endian and bass_host.set_endian
+#define BASS_ENDIAN_LSB 0
+#define BASS_ENDIAN_MSB 1
+
+//callbacks into bass, valid for the lifetime of an instance.
+//callbacks returning int return 0 once an error has been raised; the plugin should then return
+//BASS_FAILED from assemble. the error has already been reported, and assembly stops afterward.
+typedef struct bass_host {
+  void* context;  //passed as the first argument of every callback
+
+  uint32_t (*pc)(void* context);
+  int (*evaluate)(void* context, const char* expression, uint32_t mode, int64_t* value);
+  int (*write)(void* context, uint64_t data, uint32_t length);  //length in bytes, in the active endian order
+  uint32_t (*endian)(void* context);
+  void (*set_endian)(void* context, uint32_t endian);
+  int (*notice)(void* context, const char* message);
+  int (*warning)(void* context, const char* message);
+  int (*error)(void* context, const char* message);  //always returns 0
+} bass_host;
+
+//an architecture, as registered by a plugin.
+//bass creates one instance each time the architecture is selected.
+typedef struct bass_architecture {
+  uint32_t version;  //BASS_ARCHITECTURE_VERSION
+
+  void* (*create)(const bass_host* host);
+  void (*destroy)(void* instance);
+  int (*assemble)(void* instance, const char* statement, uint32_t length);
+  int (*aligned)(void* instance);  //0 while part of a byte is pending, to be completed by the next instruction
+} bass_architecture;
+
+//exported by every plugin. returns the architecture it implements,
+//or NULL if the plugin does not support the interface version bass requests.
+BASS_EXPORT const bass_architecture* bass_architecture_register(uint32_t version);
+
+#if defined(__cplusplus)
+}
+#endif
@@ -0,0 +1,101 @@
+//plugins are loaded once per process, and shared by every Plugin using them
+auto Plugin::load(const string& location) -> const bass_architecture* {
+  static mutex lock;
+  static hashset<Library> cache;
+  lock_guard<mutex> guard(lock);
+  if(auto cached = cache.find({location})) return cached().interface;
+
+  Library loaded{location};
+  loaded.handle = new library;
+  if(loaded.handle->openAbsolute(location)) {
+    using Register = auto (*)(uint32_t version) -> const bass_architecture*;
+    if(auto entry = (Register)loaded.handle->sym("bass_architecture_register")) {
+      auto interface = entry(BASS_ARCHITECTURE_VERSION);
+      if(interface && interface->version == BASS_ARCHITECTURE_VERSION) loaded.interface = interface;
+    }
+  }
+  cache.insert(loaded);
+  return loaded.interface;
+}
+
+Plugin::Plugin(Bass& self, const bass_architecture& interface) : Architecture(self), interface(interface) {
+  host.context = this;
+  host.pc = pc;
+  host.evaluate = evaluate;
+  host.write = write;
+  host.endian = endian;
+  host.set_endian = setEndian;
+  host.notice = notice;
+  host.warning = warning;
+  host.error = error;
+  instance = interface.create(&host);
+}
+
+Plugin::~Plugin() {
+  if(instance) interface.destroy(instance);
+}
+
+auto Plugin::assemble(const string& statement) -> bool {
+  if(!instance) Architecture::error("unable to create architecture instance");
+  int result = interface.assemble(instance, statement.data(), statement.size());
+  if(pending) {
+    auto exception = pending;
+    pending = nullptr;
+    std::rethrow_exception(exception);
+  }
+  if(result == BASS_FAILED) Architecture::error("architecture plugin failed to assemble statement");
+  return result == BASS_ASSEMBLED;
+}
+
+auto Plugin::aligned() const -> bool {
+  return !instance || interface.aligned(instance);
+}
+
+//exceptions cannot unwind through the plugin, so they are held until it returns
+template<typename F> auto Plugin::guard(F&& function) -> int {
+  if(pending) return 0;
+  try {
+    function();
+    return 1;
+  } catch(...) {
+    pending = std::current_exception();
+    return 0;
+  }
+}
+
+auto Plugin::pc(void* context) -> uint32_t {
+  return ((Plugin*)context)->Architecture::pc();
+}
+
+auto Plugin::evaluate(void* context, const char* expression, uint32_t mode, int64_t* value) -> int {
+  auto self = (Plugin*)context;
+  return self->guard([&] { *value = self->Architecture::evaluate(expression, (Bass::Evaluation)(mode == BASS_EVALUATE_LAX)); });
+}
+
+auto Plugin::write(void* context, uint64_t data, uint32_t length) -> int {
+  auto self = (Plugin*)context;
+  return self->guard([&] { self->Architecture::write(data, length); });
+}
+
+auto Plugin::endian(void* context) -> uint32_t {
+  return ((Plugin*)context)->Architecture::endian() == Bass::Endian::MSB ? BASS_ENDIAN_MSB : BASS_ENDIAN_LSB;
+}
+
+auto Plugin::setEndian(void* context, uint32_t endian) -> void {
+  ((Plugin*)context)->Architecture::setEndian(endian == BASS_ENDIAN_MSB ? Bass::Endian::MSB : Bass::Endian::LSB);
+}
+
+auto Plugin::notice(void* context, const char* message) -> int {
+  auto self = (Plugin*)context;
+  return self->guard([&] { self->Architecture::notice(message); });
+}
+
+auto Plugin::warning(void* context, const char* message) -> int {
+  auto self = (Plugin*)context;
+  return self->guard([&] { self->Architecture::warning(message); });
+}
+
+auto Plugin::error(void* context, const char* message) -> int {
+  auto self = (Plugin*)context;
+  return self->guard([&] { self->Architecture::error(message); });
+}
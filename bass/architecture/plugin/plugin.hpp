@@ -0,0 +1,46 @@
+//architectures loaded from shared objects, through the C interface of bass-architecture.h
+struct Plugin : Architecture {
+  #if defined(PLATFORM_WINDOWS)
+  static constexpr const char* extension = ".dll";
+  #elif defined(PLATFORM_MACOS)
+  static constexpr const char* extension = ".dylib";
+  #else
+  static constexpr const char* extension = ".so";
+  #endif
+
+  static auto load(const string& location) -> const bass_architecture*;
+
+  Plugin(Bass& self, const bass_architecture& interface);
+  ~Plugin();
+  auto assemble(const string& statement) -> bool override;
+  auto aligned() const -> bool override;
+
+private:
+  struct Library {
+    Library() {}
+    Library(const string& location) : location(location) {}
+
+    auto hash() const -> uint { return location.hash(); }
+    auto operator==(const Library& source) const -> bool { return location == source.location; }
+
+    string location;
+    shared_pointer<library> handle;  //never closed, so that interfaces remain valid
+    const bass_architecture* interface = nullptr;
+  };
+
+  template<typename F> auto guard(F&& function) -> int;
+
+  static auto pc(void* context) -> uint32_t;
+  static auto evaluate(void* context, const char* expression, uint32_t mode, int64_t* value) -> int;
+  static auto write(void* context, uint64_t data, uint32_t length) -> int;
+  static auto endian(void* context) -> uint32_t;
+  static auto setEndian(void* context, uint32_t endian) -> void;
+  static auto notice(void* context, const char* message) -> int;
+  static auto warning(void* context, const char* message) -> int;
+  static auto error(void* context, const char* message) -> int;
+
+  const bass_architecture& interface;
+  bass_host host;
+  void* instance = nullptr;
+  std::exception_ptr pending;  //raised by a callback; rethrown once the plugin returns
+};
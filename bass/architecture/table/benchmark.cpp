@@ -0,0 +1,128 @@
+//times Table::match() against the tokenize() matching it replaced. statements are made from every
+//opcode pattern of a table, with operands of several shapes, and are then matched two ways:
+//against every opcode, and against only the opcodes that Table::assemble() would try, in order.
+//both matchers must agree on which opcodes match, and on what each wildcard captures.
+auto Table::benchmark(const string& location) -> bool {
+  static constexpr uint Repeat = 100;
+
+  if(!file::exists(location)) {
+    print(stderr, "error: architecture not found: ", location, "\n");
+    return false;
+  }
+  Definition definition;
+  parseTable(definition, string::read(location));
+  Bass bass;
+  Table architecture{bass, definition};
+  auto& opcodes = definition.table;
+  auto& mnemonics = definition.mnemonics;
+  auto& wildcards = definition.wildcards;
+
+  //each wildcard is replaced with an operand of its width, then a decimal one, then a size-prefixed one
+  auto sample = [](uint bits, uint kind) -> string {
+    if(kind == 0) return {"$", slice("123456789abcdef0123456789abcdef0", 0, max(1u, bits / 4))};
+    if(kind == 1 || bits % 8 || bits > 32) return "18";
+    return {string_vector{"<", ">", "^", "?"}[bits / 8 - 1], "18"};
+  };
+
+  string_vector statements;
+  for(auto& opcode : opcodes) {
+    if(!opcode.prefix) continue;
+    for(uint kind : range(3)) {
+      string statement = opcode.prefix[0].text;
+      for(uint n : range(opcode.number.size())) {
+        statement.append(sample(opcode.number[n].bits, kind));
+        if(n + 1 < opcode.prefix.size()) statement.append(opcode.prefix[n + 1].text);
+      }
+      if(!statements.find(statement)) statements.append(statement);
+    }
+  }
+
+  //the opcodes that Table::assemble() tries for each statement, in the order it tries them
+  vector<vector<uint>> candidates;
+  for(auto& statement : statements) {
+    const vector<uint>* shape = nullptr;
+    uint length = 0;
+    while(statement[length] && statement[length] != ' ') length++;
+    if(auto mnemonic = mnemonics.find({slice(statement, 0, length)})) {
+      char first = statement[length] ? statement[length + 1] : 0;
+      shape = &mnemonic().opcodes;
+      for(auto& candidate : mnemonic().shapes) {
+        if(candidate.first == first) { shape = &candidate.opcodes; break; }
+      }
+    }
+    vector<uint> ids;
+    uint x = 0, y = 0;
+    uint xs = shape ? shape->size() : 0, ys = wildcards.size();
+    while(x < xs || y < ys) {
+      ids.append(y >= ys || (x < xs && (*shape)[x] < wildcards[y]) ? (*shape)[x++] : wildcards[y++]);
+    }
+    candidates.append(ids);
+  }
+
+  //the matching done by Table::assembleOpcode() before Table::match() was written
+  auto tokenized = [](const Opcode& opcode, const string& statement, string_vector& arguments) -> bool {
+    arguments.reset();
+    if(!tokenize(statement, opcode.pattern)) return false;
+    tokenize(arguments, statement, opcode.pattern);
+    return arguments.size() == opcode.number.size();
+  };
+
+  uint pairs = 0, matches = 0, mismatches = 0;
+  string_vector arguments;
+  for(auto& statement : statements) {
+    for(auto& opcode : opcodes) {
+      pairs++;
+      bool expected = tokenized(opcode, statement, arguments);
+      bool actual = architecture.match(opcode, statement);
+      bool same = expected == actual;
+      for(uint n : range(actual && same ? arguments.size() : 0)) {
+        if(architecture.argument(statement, n) != arguments[n]) same = false;
+      }
+      if(expected) matches++;
+      if(!same) {
+        print(stderr, "error: ", location, ": match differs from tokenize: ", statement, " [", opcode.pattern, "]\n");
+        mismatches++;
+      }
+    }
+  }
+  if(mismatches) return false;
+
+  uint tried = 0;
+  for(auto& ids : candidates) tried += ids.size();
+
+  //counts are kept, so that the loops below are not optimized away
+  uint found = 0;
+  auto clockStart = clock();
+  for(uint remaining = Repeat; remaining; remaining--) {
+    for(auto& statement : statements) {
+      for(auto& opcode : opcodes) found += tokenized(opcode, statement, arguments);
+    }
+  }
+  auto clockAllTokenize = clock();
+  for(uint remaining = Repeat; remaining; remaining--) {
+    for(auto& statement : statements) {
+      for(auto& opcode : opcodes) found += architecture.match(opcode, statement);
+    }
+  }
+  auto clockAllMatch = clock();
+  for(uint remaining = Repeat; remaining; remaining--) {
+    for(uint n : range(statements.size())) {
+      for(auto id : candidates[n]) if(tokenized(opcodes[id], statements[n], arguments)) { found++; break; }
+    }
+  }
+  auto clockCandidatesTokenize = clock();
+  for(uint remaining = Repeat; remaining; remaining--) {
+    for(uint n : range(statements.size())) {
+      for(auto id : candidates[n]) if(architecture.match(opcodes[id], statements[n])) { found++; break; }
+    }
+  }
+  auto clockCandidatesMatch = clock();
+
+  auto seconds = [](clock_t from, clock_t to) -> double { return (double)(to - from) / CLOCKS_PER_SEC; };
+  print(location, ": ", statements.size(), " statements, x", Repeat, "\n");
+  print("  every opcode (", pairs, " pairs, ", matches, " matching): ");
+  print("tokenize ", seconds(clockStart, clockAllTokenize), "s, match ", seconds(clockAllTokenize, clockAllMatch), "s\n");
+  print("  candidates (", tried, " listed): ");
+  print("tokenize ", seconds(clockAllMatch, clockCandidatesTokenize), "s, match ", seconds(clockCandidatesTokenize, clockCandidatesMatch), "s\n");
+  return found >= matches * Repeat * 2;
+}
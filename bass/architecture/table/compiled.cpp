@@ -0,0 +1,167 @@
+//compiled tables (.archc) hold a parsed definition, including its mnemonic index.
+//they record the modification time and size of the .arch file they were compiled from, and are
+//ignored once either changes, so that loading one never reads the .arch file.
+//all values are stored as little-endian 32-bit words; strings are a length followed by their bytes.
+
+auto Table::compile(const string& location) -> bool {
+  if(!file::exists(location)) return false;
+  uint64_t modified = inode::timestamp(location);
+  uint64_t size = file::size(location);
+  Definition definition;
+  parseTable(definition, string::read(location));
+
+  vector<uint8_t> data;
+  auto word = [&](uint64_t value) {
+    for(uint n : range(4)) data.append(value >> n * 8);
+  };
+  auto quad = [&](uint64_t value) {
+    word(value);
+    word(value >> 32);
+  };
+  auto text = [&](const string& value) {
+    word(value.size());
+    for(uint n : range(value.size())) data.append(value[n]);
+  };
+  auto list = [&](const vector<uint>& values) {
+    word(values.size());
+    for(auto value : values) word(value);
+  };
+
+  for(auto byte : string{"BASSARCH"}) data.append(byte);
+  word(CompiledVersion);
+  quad(modified);
+  quad(size);
+  word(!definition.endian ? 0 : definition.endian() == Bass::Endian::LSB ? 1 : 2);
+
+  word(definition.table.size());
+  for(auto& opcode : definition.table) {
+    word(opcode.prefix.size());
+    for(auto& prefix : opcode.prefix) text(prefix.text);
+    word(opcode.number.size());
+    for(auto& number : opcode.number) word(number.bits);
+    word(opcode.format.size());
+    for(auto& format : opcode.format) {
+      word((uint)format.type);
+      word((uint)format.match);
+      word(format.data);
+      word(format.bits);
+      word(format.argument);
+      word(format.displacement);
+    }
+    text(opcode.pattern);
+  }
+
+  list(definition.wildcards);
+
+  auto names = mnemonicNames(definition);
+  word(names.size());
+  for(auto& name : names) {
+    auto& mnemonic = definition.mnemonics.find({name})();
+    text(mnemonic.name);
+    list(mnemonic.opcodes);
+    word(mnemonic.shapes.size());
+    for(auto& shape : mnemonic.shapes) {
+      word((uint8_t)shape.first);
+      list(shape.opcodes);
+    }
+  }
+
+  return file::write({location, "c"}, data);
+}
+
+//returns false if the compiled table is missing, stale or malformed.
+//modified and sourceSize are those of the .arch file at location.
+auto Table::loadCompiled(Definition& definition, const string& location, uint64_t modified, uint64_t sourceSize) -> bool {
+  string compiled{location, "c"};
+  if(!file::exists(compiled)) return false;
+  file_map map{compiled, file_map::mode::read};
+  if(!map) return false;
+
+  const uint8_t* data = map.data();
+  uint64_t size = map.size(), offset = 0;
+  bool valid = true;
+  auto word = [&]() -> uint32_t {
+    if(offset + 4 > size) { valid = false; return 0; }
+    uint32_t value = data[offset] | data[offset + 1] << 8 | data[offset + 2] << 16 | data[offset + 3] << 24;
+    offset += 4;
+    return value;
+  };
+  auto text = [&]() -> string {
+    uint length = word();
+    if(!valid || offset + length > size) { valid = false; return {}; }
+    string value;
+    value.resize(length);
+    memory::copy(value.get(), data + offset, length);
+    offset += length;
+    return value;
+  };
+  auto list = [&](vector<uint>& values) {
+    uint count = word();
+    if(count > (size - offset) / 4) { valid = false; return; }
+    values.reserve(count);
+    for(uint n : range(count)) values.append(word());
+  };
+  auto count = [&]() -> uint {
+    uint count = word();
+    if(count > size - offset) valid = false;  //every entry occupies at least one byte
+    return valid ? count : 0;
+  };
+
+  if(size < 8 || memory::compare(data, "BASSARCH", 8)) return false;
+  offset = 8;
+  if(word() != CompiledVersion) return false;
+  auto quad = [&]() -> uint64_t {
+    uint64_t low = word();
+    return low | (uint64_t)word() << 32;
+  };
+  if(quad() != modified || quad() != sourceSize || !valid) return false;
+
+  auto endian = word();
+  if(endian == 1) definition.endian = Bass::Endian::LSB;
+  if(endian == 2) definition.endian = Bass::Endian::MSB;
+
+  uint opcodes = count();
+  definition.table.reserve(opcodes);
+  while(definition.table.size() < opcodes) {
+    Opcode opcode;
+    for(uint n : range(count())) {
+      auto prefix = text();
+      opcode.prefix.append({prefix, prefix.size()});
+    }
+    for(uint n : range(count())) opcode.number.append({word()});
+    for(uint n : range(count())) {
+      Format format;
+      format.type = (Format::Type)word();
+      format.match = (Format::Match)word();
+      format.data = word();
+      format.bits = word();
+      format.argument = word();
+      format.displacement = (int32_t)word();
+      if(format.argument >= opcode.number.size() && format.type != Format::Type::Static) valid = false;
+      opcode.format.append(format);
+    }
+    opcode.pattern = text();
+    if(!valid) return false;
+    definition.table.append(opcode);
+  }
+
+  //every opcode index must refer to an opcode of the table
+  auto indices = [&](vector<uint>& values) {
+    list(values);
+    for(auto id : values) if(id >= opcodes) valid = false;
+  };
+
+  indices(definition.wildcards);
+  for(uint n : range(count())) {
+    Mnemonic mnemonic{text()};
+    indices(mnemonic.opcodes);
+    for(uint n : range(count())) {
+      Shape shape{(char)word()};
+      indices(shape.opcodes);
+      mnemonic.shapes.append(shape);
+    }
+    if(!valid) return false;
+    definition.mnemonics.insert(mnemonic);
+  }
+  return valid && offset == size;
+}
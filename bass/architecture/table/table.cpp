@@ -1,7 +1,41 @@
-Table::Table(Bass& self, const string& table) : Architecture(self) {
+#include "benchmark.cpp"
+#include "compiled.cpp"
+
+//architectures are parsed once per process, and again whenever their table file changes.
+//the file is checked on every load, as it may be edited while bass is running (see --serve).
+auto Table::load(const string& location) -> const Definition* {
+  static mutex lock;
+  static hashset<CachedDefinition> cache;
+  static vector<shared_pointer<Definition>> retired;  //replaced definitions, which assemblies may still be using
+
+  if(!file::exists(location)) return nullptr;
+  uint64_t modified = inode::timestamp(location);
+  uint64_t size = file::size(location);
+
+  lock_guard<mutex> guard(lock);
+  if(auto cached = cache.find({location})) {
+    if(cached().modified == modified && cached().size == size) return cached().definition.data();
+    retired.append(cached().definition);
+    cache.remove({location});
+  }
+
+  //the cache keeps its own copy of location, as the caller's is released after the lock is
+  CachedDefinition cached{string{string_view{location}}};
+  cached.modified = modified;
+  cached.size = size;
+  cached.definition = new Definition;
+  if(!loadCompiled(cached.definition(), location, modified, size)) {
+    cached.definition = new Definition;  //discard anything read from a malformed compiled table
+    parseTable(cached.definition(), string::read(location));
+  }
+  cache.insert(cached);
+  return cached.definition.data();
+}
+
+Table::Table(Bass& self, const Definition& definition) : Architecture(self), definition(&definition) {
   bitval = 0;
   bitpos = 0;
-  parseTable(table);
+  if(definition.endian) setEndian(definition.endian());
 }
 
 auto Table::assemble(const string& statement) -> bool {
@@ -9,104 +43,140 @@ auto Table::assemble(const string& statement) -> bool {
 
   if(s.match("instrument \"*\"")) {
     s.trim("instrument \"", "\"", 1L);
-    parseTable(s);
+    if(!instrumented) {
+      //the mnemonic index is rebuilt rather than copied, as hashset's copy skips empty slots unsafely.
+      //strings are copied whole, as the shared definition may be in use by other threads.
+      instrumented = new Definition;
+      for(auto& opcode : definition->table) {
+        Opcode copy{{}, opcode.number, opcode.format, string{string_view{opcode.pattern}}};
+        for(auto& prefix : opcode.prefix) copy.prefix.append({string{string_view{prefix.text}}, prefix.size});
+        instrumented->table.append(copy);
+      }
+      instrumented->endian = definition->endian;
+      for(uint id : range(instrumented->table.size())) indexOpcode(instrumented(), id);
+      definition = instrumented.data();
+    }
+    if(auto endian = parseTable(instrumented(), s)) setEndian(endian());
     return true;
   }
 
   uint pc = Architecture::pc();
 
-  for(auto& opcode : table) {
-    if(!tokenize(s, opcode.pattern)) continue;
-
-    string_vector args;
-    tokenize(args, s, opcode.pattern);
-    if(args.size() != opcode.number.size()) continue;
-
-    bool mismatch = false;
-    for(auto& format : opcode.format) {
-      if(format.type == Format::Type::Absolute) {
-        if(format.match != Format::Match::Weak) {
-          uint bits = bitLength(args[format.argument]);
-          if(bits != opcode.number[format.argument].bits) {
-            if(format.match == Format::Match::Exact || bits != 0) {
-              mismatch = true;
-              break;
-            }
+  //only opcodes whose mnemonic and operand shape agree with the statement can match it
+  const vector<uint>* candidates = nullptr;
+  uint length = 0;
+  while(s[length] && s[length] != ' ') length++;
+  if(auto mnemonic = definition->mnemonics.find({slice(s, 0, length)})) {
+    char first = s[length] ? s[length + 1] : 0;
+    candidates = &mnemonic().opcodes;
+    for(auto& shape : mnemonic().shapes) {
+      if(shape.first == first) { candidates = &shape.opcodes; break; }
+    }
+  }
+
+  //opcodes are tried in table order, merging in any opcodes with wildcard mnemonics
+  uint x = 0, y = 0;
+  auto& wildcards = definition->wildcards;
+  uint xs = candidates ? candidates->size() : 0, ys = wildcards.size();
+  while(x < xs || y < ys) {
+    uint id = y >= ys || (x < xs && (*candidates)[x] < wildcards[y]) ? (*candidates)[x++] : wildcards[y++];
+    if(assembleOpcode(definition->table[id], s, pc)) return true;
+  }
+
+  return false;
+}
+
+auto Table::aligned() const -> bool {
+  return bitpos == 0;
+}
+
+auto Table::assembleOpcode(const Opcode& opcode, const string& s, uint pc) -> bool {
+  if(!match(opcode, s)) return false;
+
+  for(auto& format : opcode.format) {
+    if(format.type == Format::Type::Absolute) {
+      if(format.match != Format::Match::Weak) {
+        auto& argument = arguments[format.argument];
+        uint bits = 0;
+        if(!argument.prefixed) {
+          bits = bitLength(s.data() + argument.offset, argument.length);
+          argument.prefixed = argument.length && strchr("<>^?:", s[argument.offset]);
+        }
+        if(bits != opcode.number[format.argument].bits) {
+          if(format.match == Format::Match::Exact || bits != 0) {
+            return false;
           }
         }
       }
     }
-    if(mismatch) continue;
+  }
 
-    for(auto& format : opcode.format) {
-      switch(format.type) {
-        case Format::Type::Static: {
-          writeBits(format.data, format.bits);
-          break;
-        }
+  string_vector args;
+  for(uint n : range(arguments.size())) args.append(argument(s, n));
 
-        case Format::Type::Absolute: {
-          uint data = evaluate(args[format.argument], Bass::Evaluation::Lax);
-          writeBits(data, opcode.number[format.argument].bits);
-          break;
-        }
+  for(auto& format : opcode.format) {
+    switch(format.type) {
+      case Format::Type::Static: {
+        writeBits(format.data, format.bits);
+        break;
+      }
 
-        case Format::Type::Relative: {
-          int data = evaluate(args[format.argument], Bass::Evaluation::Lax) - (pc + format.displacement);
-          uint bits = opcode.number[format.argument].bits;
-          int min = -(1 << (bits - 1)), max = +(1 << (bits - 1)) - 1;
-          if(data < min || data > max) error("branch out of bounds");
-          writeBits(data, opcode.number[format.argument].bits);
-          break;
-        }
+      case Format::Type::Absolute: {
+        uint data = evaluate(args[format.argument], Bass::Evaluation::Lax);
+        writeBits(data, opcode.number[format.argument].bits);
+        break;
+      }
 
-        case Format::Type::Repeat: {
-          uint data = evaluate(args[format.argument], Bass::Evaluation::Lax);
-          for(uint n : range(data)) {
-            writeBits(format.data, opcode.number[format.argument].bits);
-          }
-          break;
+      case Format::Type::Relative: {
+        int data = evaluate(args[format.argument], Bass::Evaluation::Lax) - (pc + format.displacement);
+        uint bits = opcode.number[format.argument].bits;
+        int min = -(1 << (bits - 1)), max = +(1 << (bits - 1)) - 1;
+        if(data < min || data > max) error("branch out of bounds");
+        writeBits(data, opcode.number[format.argument].bits);
+        break;
+      }
+
+      case Format::Type::Repeat: {
+        uint data = evaluate(args[format.argument], Bass::Evaluation::Lax);
+        for(uint n : range(data)) {
+          writeBits(format.data, opcode.number[format.argument].bits);
         }
+        break;
       }
     }
-
-    return true;
   }
 
-  return false;
+  return true;
 }
 
-auto Table::bitLength(string& text) const -> uint {
-  auto binLength = [&](const char* p) -> uint {
-    uint length = 0;
-    while(*p) {
-      if(*p == '0' || *p == '1') { p++; length += 1; continue; }
-      return 0;
+auto Table::bitLength(const char* p, uint length) -> uint {
+  auto binLength = [&](uint offset) -> uint {
+    for(uint n : range(offset, length)) {
+      if(p[n] != '0' && p[n] != '1') return 0;
     }
-    return length;
+    return length - offset;
   };
 
-  auto hexLength = [&](const char* p) -> uint {
-    uint length = 0;
-    while(*p) {
-      if(*p >= '0' && *p <= '9') { p++; length += 4; continue; }
-      if(*p >= 'a' && *p <= 'f') { p++; length += 4; continue; }
-      if(*p >= 'A' && *p <= 'F') { p++; length += 4; continue; }
+  auto hexLength = [&](uint offset) -> uint {
+    for(uint n : range(offset, length)) {
+      if(p[n] >= '0' && p[n] <= '9') continue;
+      if(p[n] >= 'a' && p[n] <= 'f') continue;
+      if(p[n] >= 'A' && p[n] <= 'F') continue;
       return 0;
     }
-    return length;
+    return (length - offset) * 4;
   };
 
-  char* p = text.get();
-  if(*p == '<') { *p = ' '; return  8; }
-  if(*p == '>') { *p = ' '; return 16; }
-  if(*p == '^') { *p = ' '; return 24; }
-  if(*p == '?') { *p = ' '; return 32; }
-  if(*p == ':') { *p = ' '; return 64; }
-  if(*p == '%') return binLength(p + 1);
-  if(*p == '$') return hexLength(p + 1);
-  if(*p == '0' && *(p + 1) == 'b') return binLength(p + 2);
-  if(*p == '0' && *(p + 1) == 'x') return hexLength(p + 2);
+  if(length == 0) return 0;
+  if(*p == '<') return  8;
+  if(*p == '>') return 16;
+  if(*p == '^') return 24;
+  if(*p == '?') return 32;
+  if(*p == ':') return 64;
+  if(*p == '%') return binLength(1);
+  if(*p == '$') return hexLength(1);
+  if(length >= 2 && *p == '0' && *(p + 1) == 'b') return binLength(2);
+  if(length >= 2 && *p == '0' && *(p + 1) == 'x') return hexLength(2);
   return 0;
 }
 
@@ -122,13 +192,72 @@ auto Table::writeBits(uint64_t data, uint length) -> void {
   }
 }
 
-auto Table::parseTable(const string& text) -> bool {
+//patterns are literal prefixes separated by wildcards. each wildcard captures the text up to
+//the first occurrence of the following prefix, and the final prefix must end the statement.
+//this matches exactly what the backtracking tokenize() would, without allocating memory.
+//nothing more is precomputed: most candidates are rejected by their first prefix, and checking
+//the statement length or the final prefix first made no measurable difference (make bench-match).
+auto Table::match(const Opcode& opcode, const string& statement) -> bool {
+  const char* s = statement.data();
+  uint size = statement.size();
+  uint wildcards = opcode.number.size();
+  if(!opcode.prefix) return false;
+
+  auto compare = [&](uint offset, const Prefix& prefix) -> bool {
+    const char* p = prefix.text.data();
+    for(uint n : range(prefix.size)) {
+      if(s[offset + n] != p[n]) return false;
+    }
+    return true;
+  };
+
+  auto& first = opcode.prefix[0];
+  if(size < first.size || !compare(0, first)) return false;
+  uint offset = first.size;
+  if(!wildcards) return offset == size;
+
+  arguments.resize(wildcards);
+  for(uint n : range(wildcards)) {
+    uint position = offset;
+    uint length = 0;
+    if(n + 1 < opcode.prefix.size()) {
+      auto& next = opcode.prefix[n + 1];
+      length = next.size;
+      if(n + 1 == wildcards) {
+        if(size < offset + length) return false;
+        position = size - length;
+        if(!compare(position, next)) return false;
+      } else if(length) {
+        auto found = statement.findFrom(offset, next.text);
+        if(!found) return false;
+        position = offset + found();
+      }
+    } else {
+      position = size;  //pattern ends with a wildcard
+    }
+    arguments[n] = {offset, position - offset, false};
+    offset = position + length;
+  }
+
+  return true;
+}
+
+auto Table::argument(const string& statement, uint index) const -> string {
+  auto& argument = arguments[index];
+  string text = slice(statement, argument.offset, argument.length);
+  if(argument.prefixed) text.get()[0] = ' ';
+  return text;
+}
+
+//returns the last endian directive of text, which the table selects when it is used
+auto Table::parseTable(Definition& definition, const string& text) -> maybe<Bass::Endian> {
+  maybe<Bass::Endian> endian;
   auto lines = text.split("\n");
   for(auto& line : lines) {
     if(auto position = line.find("//")) line.resize(position());  //remove comments
 
-    if(line == "endian lsb") { setEndian(Bass::Endian::LSB); continue; }
-    if(line == "endian msb") { setEndian(Bass::Endian::MSB); continue; }
+    if(line == "endian lsb") { endian = Bass::Endian::LSB; continue; }
+    if(line == "endian msb") { endian = Bass::Endian::MSB; continue; }
 
     auto part = line.split(";", 1L).strip();
     if(part.size() != 2) continue;
@@ -136,10 +265,57 @@ auto Table::parseTable(const string& text) -> bool {
     Opcode opcode;
     assembleTableLHS(opcode, part(0));
     assembleTableRHS(opcode, part(1));
-    table.append(opcode);
+    definition.table.append(opcode);
+    indexOpcode(definition, definition.table.size() - 1);
   }
 
-  return true;
+  if(endian) definition.endian = endian;
+  return endian;
+}
+
+auto Table::indexOpcode(Definition& definition, uint id) -> void {
+  auto& pattern = definition.table[id].pattern;
+  uint length = 0;
+  while(pattern[length] && pattern[length] != ' ' && pattern[length] != '*') length++;
+  if(pattern[length] == '*') return definition.wildcards.append(id);
+
+  string name = slice(pattern, 0, length);
+  auto mnemonic = definition.mnemonics.find({name});
+  if(!mnemonic) mnemonic = definition.mnemonics.insert({name});
+
+  maybe<char> first;
+  if(!pattern[length]) first = 0;
+  else if(pattern[length + 1] != '*') first = pattern[length + 1];
+  indexShape(mnemonic(), id, first);
+}
+
+//hashset cannot be enumerated, so mnemonics are recovered from the patterns in table order
+auto Table::mnemonicNames(const Definition& definition) -> string_vector {
+  string_vector names;
+  for(auto& opcode : definition.table) {
+    auto& pattern = opcode.pattern;
+    uint length = 0;
+    while(pattern[length] && pattern[length] != ' ' && pattern[length] != '*') length++;
+    if(pattern[length] == '*') continue;
+    string name = slice(pattern, 0, length);
+    if(!names.find(name)) names.append(name);
+  }
+  return names;
+}
+
+//opcodes without a literal first operand character are candidates for every operand shape
+auto Table::indexShape(Mnemonic& mnemonic, uint id, maybe<char> first) -> void {
+  if(!first) {
+    for(auto& shape : mnemonic.shapes) shape.opcodes.append(id);
+    mnemonic.opcodes.append(id);
+    return;
+  }
+
+  for(auto& shape : mnemonic.shapes) {
+    if(shape.first == first()) return shape.opcodes.append(id);
+  }
+  mnemonic.shapes.append({first(), mnemonic.opcodes});
+  mnemonic.shapes.right().opcodes.append(id);
 }
 
 auto Table::assembleTableLHS(Opcode& opcode, const string& text) -> void {
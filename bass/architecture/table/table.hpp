@@ -1,6 +1,12 @@
 struct Table : Architecture {
-  Table(Bass& self, const string& table);
+  struct Definition;
+  static auto load(const string& location) -> const Definition*;
+  static auto benchmark(const string& location) -> bool;
+  static auto compile(const string& location) -> bool;
+
+  Table(Bass& self, const Definition& definition);
   auto assemble(const string& statement) -> bool override;
+  auto aligned() const -> bool override;
 
 private:
   struct Prefix {
@@ -28,12 +34,73 @@ private:
     string pattern;
   };
 
-  auto bitLength(string& text) const -> uint;
+  //span of the statement matched by a wildcard of an opcode pattern
+  struct Argument {
+    uint offset;
+    uint length;
+    bool prefixed;  //size prefix (eg <, >) was consumed by bitLength()
+  };
+
+  //opcodes that can match statements whose operand begins with a given character
+  struct Shape {
+    char first;
+    vector<uint> opcodes;
+  };
+
+  //opcodes sharing the literal text before the first space of their patterns
+  struct Mnemonic {
+    Mnemonic() {}
+    Mnemonic(const string& name) : name(name) {}
+
+    auto hash() const -> uint { return name.hash(); }
+    auto operator==(const Mnemonic& source) const -> bool { return name == source.name; }
+
+    string name;
+    vector<Shape> shapes;
+    vector<uint> opcodes;  //opcodes that accept any operand shape
+  };
+
+public:
+  //parsed opcode table; loaded once per process (until its file changes), and shared by every Table using it
+  struct Definition {
+    vector<Opcode> table;
+    mutable hashset<Mnemonic> mnemonics;  //find() is not const, but does not modify the set
+    vector<uint> wildcards;  //opcodes whose mnemonic contains a wildcard, and so may match any statement
+    maybe<Bass::Endian> endian;
+  };
+
+private:
+  struct CachedDefinition {
+    CachedDefinition() {}
+    CachedDefinition(const string& location) : location(location) {}
+
+    auto hash() const -> uint { return location.hash(); }
+    auto operator==(const CachedDefinition& source) const -> bool { return location == source.location; }
+
+    string location;  //path of the table file
+    uint64_t modified;
+    uint64_t size;
+    shared_pointer<Definition> definition;
+  };
+
+  static constexpr uint32_t CompiledVersion = 3;
+
+  static auto bitLength(const char* text, uint length) -> uint;
   auto writeBits(uint64_t data, uint bits) -> void;
-  auto parseTable(const string& text) -> bool;
-  auto assembleTableLHS(Opcode& opcode, const string& text) -> void;
-  auto assembleTableRHS(Opcode& opcode, const string& text) -> void;
+  auto match(const Opcode& opcode, const string& statement) -> bool;
+  auto argument(const string& statement, uint index) const -> string;
+  auto assembleOpcode(const Opcode& opcode, const string& statement, uint pc) -> bool;
+  static auto loadCompiled(Definition& definition, const string& location, uint64_t modified, uint64_t sourceSize) -> bool;
+  static auto parseTable(Definition& definition, const string& text) -> maybe<Bass::Endian>;
+  static auto indexOpcode(Definition& definition, uint id) -> void;
+  static auto mnemonicNames(const Definition& definition) -> string_vector;
+  static auto indexShape(Mnemonic& mnemonic, uint id, maybe<char> first) -> void;
+  static auto assembleTableLHS(Opcode& opcode, const string& text) -> void;
+  static auto assembleTableRHS(Opcode& opcode, const string& text) -> void;
 
-  vector<Opcode> table;
+  const Definition* definition;
+  unique_pointer<Definition> instrumented;  //copy of definition, once modified by instrument
+  vector<Argument> arguments;  //arguments of the most recent match()
   uint64_t bitval, bitpos;
+  friend struct Native;
 };
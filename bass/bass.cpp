@@ -7,6 +7,12 @@
 #include "bass.hpp"
 #include "core/core.cpp"
 #include "architecture/table/table.cpp"
+#include "architecture/native/native.cpp"
+#include "architecture/plugin/plugin.cpp"
+#include "cache/cache.cpp"
+#include "job/job.cpp"
+#include "batch/batch.cpp"
+#include "server/server.cpp"
 
 #include <nall/main.hpp>
 auto nall::main(Arguments arguments) -> void {
@@ -22,61 +28,95 @@ auto nall::main(Arguments arguments) -> void {
     print(stderr, "  -d name[=value]  create define with optional value\n");
     print(stderr, "  -c name[=value]  create constant with optional value\n");
     print(stderr, "  -sym filename    create symbol file\n");
+    print(stderr, "  -dep filename    create make dependency file\n");
     print(stderr, "  -strict          upgrade warnings to errors\n");
     print(stderr, "  -benchmark       benchmark performance\n");
+    print(stderr, "  -cache directory reuse the results of identical assemblies\n");
+    print(stderr, "  -C directory     find relative filenames from directory\n");
+    print(stderr, "\n");
+    print(stderr, "  bass-untech --bench-match table.arch [table.arch ...]\n");
+    print(stderr, "  bass-untech --compile-arch table.arch [table.arch ...]\n");
+    print(stderr, "  bass-untech --generate-arch target.hpp table.arch [table.arch ...]\n");
+    print(stderr, "  bass-untech --verify-arch name [name ...]\n");
+    print(stderr, "  bass-untech --serve socket\n");
+    print(stderr, "  bass-untech --batch manifest [-j count]\n");
     exit(EXIT_FAILURE);
   }
 
-  string targetFilename;
-  bool create = false;
-  if(arguments.take("-o", targetFilename)) create = true;
-  if(arguments.take("-m", targetFilename)) create = false;
-
-  vector<string> defines;
-  string define;
-  while(arguments.take("-d", define)) defines.append(define);
+  if(arguments.take("--bench-match")) {
+    bool matched = true;
+    for(auto& location : arguments) matched &= Table::benchmark(location);
+    if(!matched) exit(EXIT_FAILURE);
+    return;
+  }
 
-  vector<string> constants;
-  string constant;
-  while(arguments.take("-c", constant)) constants.append(constant);
+  if(arguments.take("--compile-arch")) {
+    if(!arguments) {
+      print(stderr, "error: no architecture files given\n");
+      exit(EXIT_FAILURE);
+    }
+    for(auto& location : arguments) {
+      if(!Table::compile(location)) {
+        print(stderr, "error: unable to compile architecture: ", location, "\n");
+        exit(EXIT_FAILURE);
+      }
+    }
+    return;
+  }
 
-  string symFilename;
-  arguments.take("-sym", symFilename);
+  if(arguments.take("--generate-arch")) {
+    if(arguments.size() < 2) {
+      print(stderr, "error: no architecture files given\n");
+      exit(EXIT_FAILURE);
+    }
+    string location = arguments.take();
+    string_vector tables;
+    for(auto& table : arguments) tables.append(table);
+    if(!Native::generate(location, tables)) exit(EXIT_FAILURE);
+    return;
+  }
 
-  bool strict = arguments.take("-strict");
-  bool benchmark = arguments.take("-benchmark");
+  if(arguments.take("--verify-arch")) {
+    bool verified = true;
+    for(auto& name : arguments) verified &= Native::verify(name);
+    if(!verified) exit(EXIT_FAILURE);
+    return;
+  }
 
-  if(arguments.find("-*")) {
-    print(stderr, "error: unrecognized argument(s)\n");
+  if(arguments.take("--serve")) {
+    #if defined(API_POSIX)
+    Server server;
+    string location = arguments.take();
+    if(!server.open(location)) {
+      print(stderr, "error: unable to serve on socket: ", location, "\n");
+      exit(EXIT_FAILURE);
+    }
+    server.main();
+    return;
+    #else
+    print(stderr, "error: --serve requires Unix sockets\n");
     exit(EXIT_FAILURE);
+    #endif
   }
 
-  vector<string> sourceFilenames;
-  for(auto& argument : arguments) sourceFilenames.append(argument);
-
-  clock_t clockStart = clock();
-  Bass bass;
-  bass.target(targetFilename, create);
-  if(symFilename) {
-    bass.symFile(symFilename);
-  }
-  for(auto& sourceFilename : sourceFilenames) {
-    bass.source(sourceFilename);
-  }
-  for(auto& define : defines) {
-    auto p = define.split("=", 1L);
-    bass.define(p(0), p(1));
-  }
-  for(auto& constant : constants) {
-    auto p = constant.split("=", 1L);
-    bass.constant(p(0), p(1, "1"));
+  if(arguments.take("--batch")) {
+    uint threads = std::thread::hardware_concurrency();
+    string count;
+    if(arguments.take("-j", count)) threads = count.natural();
+    if(arguments.size() != 1) {
+      print(stderr, "error: no manifest given\n");
+      exit(EXIT_FAILURE);
+    }
+    Batch batch;
+    if(!batch.load(arguments.take())) exit(EXIT_FAILURE);
+    if(!batch.run(max(1u, threads))) exit(EXIT_FAILURE);
+    return;
   }
-  if(!bass.assemble(strict)) {
-    print(stderr, "bass: assembly failed\n");
+
+  Job job;
+  if(!job.parse(arguments)) {
+    print(stderr, "error: unrecognized argument(s)\n");
     exit(EXIT_FAILURE);
   }
-  clock_t clockFinish = clock();
-  if(benchmark) {
-    print(stderr, "bass: assembled in ", (double)(clockFinish - clockStart) / CLOCKS_PER_SEC, " seconds\n");
-  }
+  if(!job.run()) exit(EXIT_FAILURE);
 }
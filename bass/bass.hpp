@@ -1,9 +1,22 @@
 #define Architecture NallArchitecture
 #include <nall/nall.hpp>
+#include <nall/http/role.hpp>
+#include <thread>
 using namespace nall;
 using string_vector = vector<string>;
 #undef Architecture
 
+#if defined(API_POSIX)
+  #include <sys/un.h>
+#endif
+
 #include "core/core.hpp"
 #include "architecture/architecture.hpp"
 #include "architecture/table/table.hpp"
+#include "architecture/native/native.hpp"
+#include "architecture/plugin/bass-architecture.h"
+#include "architecture/plugin/plugin.hpp"
+#include "cache/cache.hpp"
+#include "job/job.hpp"
+#include "batch/batch.hpp"
+#include "server/server.hpp"
@@ -0,0 +1,63 @@
+//the manifest lists jobs separated by blank lines. each lists its arguments one per line, as they
+//would be given on the command line. relative filenames are found from the manifest's directory.
+auto Batch::load(const string& manifest) -> bool {
+  if(!file::exists(manifest)) {
+    print(stderr, "error: manifest not found: ", manifest, "\n");
+    return false;
+  }
+
+  string directory = Location::path(manifest);
+  string_vector arguments{"bass-untech"};
+  uint jobLine = 0;  //line of the manifest on which the job being read begins
+  auto lines = string::read(manifest).split("\n");
+  lines.append("");  //the last job need not be followed by a blank line
+  for(uint lineNumber : range(lines.size())) {
+    auto& line = lines[lineNumber].trimRight("\r", 1L);
+    if(line) {
+      if(arguments.size() == 1) jobLine = lineNumber + 1;
+      arguments.append(line);
+      continue;
+    }
+    if(arguments.size() == 1) continue;
+
+    Job job;
+    Arguments parameters{arguments};
+    if(!job.parse(parameters) || !job.sourceFilenames) {
+      print(stderr, "error: invalid job: ", manifest, ":", jobLine, "\n");
+      return false;
+    }
+    if(directory) job.resolve(directory);
+    job.standardOutput = false;
+    job.sources = &sources;
+    jobs.append(job);
+    arguments = {"bass-untech"};
+  }
+  return true;
+}
+
+//returns true if every job assembled
+auto Batch::run(uint threads) -> bool {
+  atomic<uint> next{0};
+  atomic<uint> failures{0};
+  mutex lock;  //held while the diagnostics of a job are printed
+
+  auto worker = [&](uintptr) {
+    for(uint index = next++; index < jobs.size(); index = next++) {
+      auto& job = jobs[index];
+      string diagnostics;
+      job.diagnostic = [&](const string& text) { diagnostics.append(text); };
+      if(!job.run()) failures++;
+      lock_guard<mutex> guard(lock);
+      print(stderr, diagnostics);
+    }
+  };
+
+  vector<thread> workers;
+  while(workers.size() < min(threads, (uint)jobs.size())) {
+    workers.append(thread::create(worker, 0, Job::StackSize));
+  }
+  for(auto& worker : workers) worker.join();
+
+  if(failures) print(stderr, "bass: ", failures.load(), " of ", jobs.size(), " assemblies failed\n");
+  return !failures;
+}
@@ -0,0 +1,10 @@
+//assembles the jobs listed by a manifest, several at once, with --batch.
+//jobs share source files, and the diagnostics of each are printed together once it completes.
+struct Batch {
+  auto load(const string& manifest) -> bool;
+  auto run(uint threads) -> bool;
+
+private:
+  vector<Job> jobs;
+  Bass::SourceCache sources;
+};
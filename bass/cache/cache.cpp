@@ -0,0 +1,111 @@
+Cache::Cache(const string& directory, const string& key) : directory(directory) {
+  if(!this->directory.endsWith("/")) this->directory.append("/");
+  manifest = {this->directory, Hash::SHA256(string{Version, "\n", build(), "\n", key}).digest(), ".manifest"};
+}
+
+//writes the outputs recorded by the manifest, if none of its inputs have changed.
+//inputs and outputs are set to the files listed by the manifest.
+auto Cache::restore(string_vector& inputs, string_vector& outputs) -> bool {
+  if(!file::exists(manifest)) return false;
+  auto lines = string::read(manifest).split("\n");
+  if(!lines || lines.takeLeft() != Version) return false;
+
+  bool complete = false;  //manifests end with a marker, so that truncated files are never trusted
+  for(auto& line : lines) {
+    if(line == "end") { complete = true; break; }
+    auto part = line.split(" ", 2L);
+    if(part.size() != 3) return false;
+    if(part[0] == "input") {
+      if(hash(part[2]) != part[1]) return false;
+    } else if(part[0] == "output") {
+      //a damaged blob is removed, so that it is replaced when the run is next recorded
+      string blob = {directory, part[1]};
+      if(hash(blob) != part[1]) return file::remove(blob), false;
+    } else {
+      return false;
+    }
+  }
+  if(!complete) return false;
+
+  inputs.reset();
+  outputs.reset();
+  for(auto& line : lines) {
+    if(line == "end") break;
+    auto part = line.split(" ", 2L);
+    if(part[0] == "input") inputs.append(part[2]);
+    if(part[0] == "output") {
+      if(!file::copy({directory, part[1]}, part[2])) return false;
+      outputs.append(part[2]);
+    }
+  }
+  return true;
+}
+
+//records the result of a successful assembly. files that were both read and written cannot be
+//restored from the hash of their original contents, and so such runs are not recorded.
+auto Cache::store(const string_vector& inputs, const string_vector& outputs) -> bool {
+  for(auto& input : inputs) {
+    if(outputs.find(input)) return false;
+  }
+  if(!nall::directory::exists(directory) && !nall::directory::create(directory)) return false;
+
+  string text = {Version, "\n"};
+  for(auto& input : inputs) {
+    auto digest = hash(input);
+    if(digest == "unreadable") return false;
+    text.append("input ", digest, " ", input, "\n");
+  }
+  for(auto& output : outputs) {
+    auto digest = hash(output);
+    if(digest == "missing" || digest == "unreadable") return false;
+    string blob = {directory, digest};
+    if(!file::exists(blob)) {
+      string copy = temporary(blob);
+      if(!file::copy(output, copy)) return file::remove(copy), false;
+      if(!file::move(copy, blob)) return file::remove(copy), false;
+    }
+    text.append("output ", digest, " ", output, "\n");
+  }
+  text.append("end\n");
+
+  //the manifest is replaced at once, as other processes may be reading it
+  string copy = temporary(manifest);
+  if(!file::write(copy, text)) return file::remove(copy), false;
+  if(!file::move(copy, manifest)) return file::remove(copy), false;
+  return true;
+}
+
+//returns the SHA-256 digest of a file, or "missing" if it does not exist
+auto Cache::hash(const string& filename) -> string {
+  if(!file::exists(filename)) return "missing";
+  if(!file::size(filename)) return Hash::SHA256().digest();
+  file_map fp{filename, file_map::mode::read};
+  if(!fp) return "unreadable";
+  Hash::SHA256 sha256;
+  sha256.input(fp.data(), fp.size());
+  return sha256.digest();
+}
+
+//returns the SHA-256 digest of the running executable. it is part of every key, as a build of
+//bass that assembles differently must not restore the runs recorded by another.
+auto Cache::build() -> string {
+  static const string digest = [] {
+    #if defined(API_WINDOWS)
+    wchar_t path[PATH_MAX] = L"";
+    GetModuleFileName(nullptr, path, PATH_MAX);
+    return hash((const char*)utf8_t(path));
+    #else
+    Dl_info info;
+    if(!dladdr((void*)&Cache::build, &info) || !info.dli_fname) return string{"unknown"};
+    return hash(info.dli_fname);
+    #endif
+  }();
+  return string{string_view{digest}};  //a separate copy, as string reference counts must not be shared between threads
+}
+
+//files are written under a unique name and then moved into place, so that a file being written
+//is never mistaken for a complete one. the counter keeps names apart between threads.
+auto Cache::temporary(const string& filename) -> string {
+  static atomic<uint> counter{0};
+  return {filename, ".", hex(chrono::nanosecond()), ".", counter++};
+}
@@ -0,0 +1,19 @@
+//content-addressed cache of whole assemblies, enabled with -cache directory.
+//a run is identified by a key computed from its options. its manifest lists the hash of every
+//file the run read (or found missing), and of every file it wrote. written files are kept in
+//the cache directory, named by their hash, and restored when every input hash still matches.
+struct Cache {
+  Cache(const string& directory, const string& key);
+  auto restore(string_vector& inputs, string_vector& outputs) -> bool;
+  auto store(const string_vector& inputs, const string_vector& outputs) -> bool;
+
+  static auto hash(const string& filename) -> string;
+
+private:
+  static constexpr const char* Version = "bass-untech cache 1";
+  static auto build() -> string;
+  static auto temporary(const string& filename) -> string;
+
+  string directory;
+  string manifest;  //path of the manifest for this key
+};
@@ -5,6 +5,11 @@ auto Bass::analyze() -> bool {
   while(ip < program.size()) {
     Instruction& i = program(ip++);
     if(!analyzeInstruction(i)) error("unrecognized directive: ", i.statement);
+
+    //{define} substitutions can change the directive, so such statements are decoded when executed
+    i.dynamic = false;
+    if(auto x = i.statement.find("{")) i.dynamic = (bool)i.statement.findNext(x(), "}");
+    if(!i.dynamic) i.decoded = decode(i.statement);
   }
 
   return true;
@@ -132,3 +137,169 @@ auto Bass::analyzeInstruction(Instruction& i) -> bool {
 
   return true;
 }
+
+auto Bass::decode(const string& statement) -> Statement {
+  Statement result;
+  result.text = statement;
+  result.level = Frame::Level::Active;
+  //only one specifier is removed: any other is left in the text, and so rejected as invalid
+  if(result.text.beginsWith("global ")) result.text.trimLeft("global ", 1L), result.level = Frame::Level::Global;
+  else if(result.text.beginsWith("parent ")) result.text.trimLeft("parent ", 1L), result.level = Frame::Level::Parent;
+
+  //directives that can decline a statement are followed by the next directive that matches it
+  auto directive = decodeDirective(result, Directive::Type::Macro);
+  while(true) {
+    result.directives.append(directive);
+    if(directive.type != Directive::Type::ArrayAssign
+    && directive.type != Directive::Type::Invoke
+    && directive.type != Directive::Type::Copy
+    && directive.type != Directive::Type::Tracker
+    ) break;
+    directive = decodeDirective(result, Directive::Type((uint)directive.type + 1));
+  }
+
+  return result;
+}
+
+//returns the first directive, starting from the given type, that matches the statement
+auto Bass::decodeDirective(const Statement& statement, Directive::Type from) -> Directive {
+  using Type = Directive::Type;
+  string s = statement.text;
+
+  if(from <= Type::Macro && s.match("macro ?*(*) {")) {
+    auto p = s.trim("macro ", ") {", 1L).split("(", 1L).strip();
+    return {Type::Macro, {p(0), p(1)}};
+  }
+
+  if(from <= Type::Inline && s.match("inline ?*(*) {")) {
+    auto p = s.trim("inline ", ") {", 1L).split("(", 1L).strip();
+    return {Type::Inline, {p(0), p(1)}};
+  }
+
+  if(from <= Type::DefineFunction && s.match("define ?*(*)*")) {
+    auto e = s.trimLeft("define ", 1L).split("=", 1L).strip();
+    auto p = e(0).trimRight(")", 1L).split("(", 1L).strip();
+    return {Type::DefineFunction, {p(0), p(1), e(1)}};
+  }
+
+  if(from <= Type::Define && s.match("define ?*")) {
+    auto p = s.trimLeft("define ", 1L).split("=", 1L).strip();
+    return {Type::Define, {p(0), p(1)}};
+  }
+
+  if(from <= Type::Evaluate && s.match("evaluate ?*")) {
+    auto p = s.trimLeft("evaluate ", 1L).split("=", 1L).strip();
+    return {Type::Evaluate, {p(0), p(1)}};
+  }
+
+  if(from <= Type::ExpressionFunction && s.match("expression ?*(*)*")) {
+    auto e = s.trimLeft("expression ", 1L).split("=", 1L).strip();
+    auto p = e(0).trimRight(")", 1L).split("(", 1L).strip();
+    return {Type::ExpressionFunction, {p(0), p(1), e(1)}};
+  }
+
+  if(from <= Type::Variable && s.match("variable ?*")) {
+    auto p = s.trimLeft("variable ", 1L).split("=", 1L).strip();
+    return {Type::Variable, {p(0), p(1)}};
+  }
+
+  if(from <= Type::Array && s.match("array[?*] ?*")) {
+    auto a = s.trimLeft("array[", 1L).split("]", 1L);
+    auto p = a(1).split("=", 1L).strip();
+    return {Type::Array, {a(0), p(0), p(1)}};
+  }
+
+  //evaluate() will evaluate array[index] to a value prior to evaluating =
+  //as a result, array[index] assignment must be manually captured early
+  if(from <= Type::ArrayAssign && s.match("?*[?*] = ?*")) {
+    auto a = s.split("[", 1L).strip();
+    auto b = a(1).split("]", 1L).strip();
+    auto c = b(1).split("=", 1L).strip();
+    return {Type::ArrayAssign, {a(0), b(0), c(1)}};
+  }
+
+  //frame specifiers are only valid for the directives above
+  if(from <= Type::InvalidFrame && statement.level != Frame::Level::Active) return {Type::InvalidFrame};
+
+  if(from <= Type::If && s.match("if ?* {")) {
+    return {Type::If, {s.trim("if ", " {", 1L).strip()}};
+  }
+
+  if(from <= Type::ElseIf && s.match("} else if ?* {")) {
+    return {Type::ElseIf, {s.trim("} else if ", " {", 1L).strip()}};
+  }
+
+  if(from <= Type::Else && s.match("} else {")) return {Type::Else};
+  if(from <= Type::EndIf && s.match("} endif")) return {Type::EndIf};
+
+  if(from <= Type::While && s.match("while ?* {")) {
+    return {Type::While, {s.trim("while ", " {", 1L).strip()}};
+  }
+
+  if(from <= Type::EndWhile && s.match("} endwhile")) return {Type::EndWhile};
+
+  if(from <= Type::Invoke && s.match("?*(*)")) {
+    auto p = string{s}.trimRight(")", 1L).split("(", 1L).strip();
+    return {Type::Invoke, {p(0), p(1)}};
+  }
+
+  if(from <= Type::EndMacro && (s.match("} endmacro") || s.match("} endinline"))) return {Type::EndMacro};
+
+  if(from <= Type::Block && s.match("block {")) return {Type::Block};
+  if(from <= Type::EndBlock && s.match("} endblock")) return {Type::EndBlock};
+
+  if(from <= Type::Namespace && s.match("namespace ?* {")) {
+    return {Type::Namespace, {s.trim("namespace ", "{", 1L).strip()}};
+  }
+
+  if(from <= Type::EndNamespace && s.match("} endnamespace")) return {Type::EndNamespace};
+
+  if(from <= Type::Function && s.match("function ?* {")) {
+    return {Type::Function, {s.trim("function ", "{", 1L).strip()}};
+  }
+
+  if(from <= Type::EndFunction && s.match("} endfunction")) return {Type::EndFunction};
+
+  if(from <= Type::Constant && s.match("constant ?*")) {
+    auto p = s.trimLeft("constant ", 1L).split("=", 1L).strip();
+    return {Type::Constant, {p(0), p(1)}};
+  }
+
+  if(from <= Type::Label && (s.match("?*:") || s.match("?*: {"))) {
+    s.trimRight(" {", 1L);
+    s.trimRight(":", 1L);
+    return {Type::Label, {s}};
+  }
+
+  if(from <= Type::LastLabel && (s.match("-") || s.match("- {"))) return {Type::LastLabel};
+  if(from <= Type::NextLabel && (s.match("+") || s.match("+ {"))) return {Type::NextLabel};
+  if(from <= Type::EndConstant && s.match("} endconstant")) return {Type::EndConstant};
+
+  if(from <= Type::Output && s.match("output ?*")) return {Type::Output, {s.trimLeft("output ", 1L)}};
+  if(from <= Type::Architecture && s.match("architecture ?*")) return {Type::Architecture, {s.trimLeft("architecture ", 1L)}};
+  if(from <= Type::Endian && s.match("endian ?*")) return {Type::Endian, {s.trimLeft("endian ", 1L)}};
+  if(from <= Type::Origin && s.match("origin ?*")) return {Type::Origin, {s.trimLeft("origin ", 1L)}};
+  if(from <= Type::Base && s.match("base ?*")) return {Type::Base, {s.trimLeft("base ", 1L)}};
+  if(from <= Type::Enqueue && s.match("enqueue ?*")) return {Type::Enqueue, {s.trimLeft("enqueue ", 1L)}};
+  if(from <= Type::Dequeue && s.match("dequeue ?*")) return {Type::Dequeue, {s.trimLeft("dequeue ", 1L)}};
+  if(from <= Type::Copy && s.match("copy ?*")) return {Type::Copy, {s.trimLeft("copy ", 1L)}};
+  if(from <= Type::Insert && s.match("insert ?*")) return {Type::Insert, {s.trimLeft("insert ", 1L)}};
+  if(from <= Type::Delete && s.match("delete ?*")) return {Type::Delete, {s.trimLeft("delete ", 1L)}};
+  if(from <= Type::Fill && s.match("fill ?*")) return {Type::Fill, {s.trimLeft("fill ", 1L)}};
+  if(from <= Type::Map && s.match("map ?*")) return {Type::Map, {s.trimLeft("map ", 1L)}};
+
+  if(from <= Type::DataByte && s.beginsWith("db ")) return {Type::DataByte, {slice(s, 3)}};
+  if(from <= Type::DataWord && s.beginsWith("dw ")) return {Type::DataWord, {slice(s, 3)}};
+  if(from <= Type::DataLong && s.beginsWith("dl ")) return {Type::DataLong, {slice(s, 3)}};
+  if(from <= Type::DataDouble && s.beginsWith("dd ")) return {Type::DataDouble, {slice(s, 3)}};
+  if(from <= Type::DataQuad && s.beginsWith("dq ")) return {Type::DataQuad, {slice(s, 3)}};
+
+  if(from <= Type::Ds && s.match("ds ?*")) return {Type::Ds, {s.trimLeft("ds ", 1L)}};
+  if(from <= Type::Tracker && s.match("tracker ?*")) return {Type::Tracker, {s.trimLeft("tracker ", 1L).strip()}};
+  if(from <= Type::Print && s.match("print ?*")) return {Type::Print, {s.trimLeft("print ", 1L).strip()}};
+  if(from <= Type::Notice && s.match("notice ?*")) return {Type::Notice, {s.trimLeft("notice ", 1L).strip()}};
+  if(from <= Type::Warning && s.match("warning ?*")) return {Type::Warning, {s.trimLeft("warning ", 1L).strip()}};
+  if(from <= Type::Error && s.match("error ?*")) return {Type::Error, {s.trimLeft("error ", 1L).strip()}};
+
+  return {Type::Instruction};
+}
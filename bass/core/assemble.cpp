@@ -2,6 +2,7 @@ auto Bass::initialize() -> void {
   queue.reset();
   scope.reset();
   for(uint n : range(256)) stringTable[n] = n;
+  stringTableVersion = 0;
   endian = Endian::LSB;
   origin = 0;
   base = 0;
@@ -9,82 +10,79 @@ auto Bass::initialize() -> void {
   nextLabelCounter = 1;
 }
 
-auto Bass::assemble(const string& statement) -> bool {
-  string s = statement;
+auto Bass::assemble(const Statement& statement, const Directive& directive) -> bool {
+  using Type = Directive::Type;
+  auto& o = directive.operands;
 
-  if(s.match("block {")) return true;
-  if(s.match("} endblock")) return true;
+  switch(directive.type) {
+  case Type::Block: return true;
+  case Type::EndBlock: return true;
 
   //namespace name {
-  if(s.match("namespace ?* {")) {
-    s.trim("namespace ", "{", 1L).strip();
-    if(!validate(s)) error("invalid namespace specifier: ", s);
-    scope.append(s);
+  case Type::Namespace: {
+    if(!validate(o[0])) error("invalid namespace specifier: ", o[0]);
+    pushScope(o[0]);
     return true;
   }
 
   //}
-  if(s.match("} endnamespace")) {
-    scope.removeRight();
+  case Type::EndNamespace: {
+    popScope();
     return true;
   }
 
   //function name {
-  if(s.match("function ?* {")) {
-    s.trim("function ", "{", 1L).strip();
-    setConstant(s, pc());
-    writeSymbolLabel(pc(), s);
-    scope.append(s);
+  case Type::Function: {
+    setConstant(o[0], pc());
+    writeSymbolLabel(pc(), o[0]);
+    pushScope(o[0]);
     return true;
   }
 
   //}
-  if(s.match("} endfunction")) {
-    scope.removeRight();
+  case Type::EndFunction: {
+    popScope();
     return true;
   }
 
   //constant name(value)
-  if(s.match("constant ?*")) {
-    auto p = s.trimLeft("constant ", 1L).split("=", 1L).strip();
-    auto v = evaluate(p(1), Evaluation::Lax);
+  case Type::Constant: {
+    auto v = evaluate(o[1], Evaluation::Lax);
     if(forwardReference) {
-      setUnknownConstant(p(0));
+      setUnknownConstant(o[0]);
     } else {
-      setConstant(p(0), v);
+      setConstant(o[0], v);
     }
     return true;
   }
 
   //label: or label: {
-  if(s.match("?*:") || s.match("?*: {")) {
-    s.trimRight(" {", 1L);
-    s.trimRight(":", 1L);
-    setConstant(s, pc());
-    writeSymbolLabel(pc(), s);
+  case Type::Label: {
+    setConstant(o[0], pc());
+    writeSymbolLabel(pc(), o[0]);
     return true;
   }
 
   //- or - {
-  if(s.match("-") || s.match("- {")) {
+  case Type::LastLabel: {
     setConstant({"lastLabel#", lastLabelCounter++}, pc());
     return true;
   }
 
   //+ or + {
-  if(s.match("+") || s.match("+ {")) {
+  case Type::NextLabel: {
     setConstant({"nextLabel#", nextLabelCounter++}, pc());
     return true;
   }
 
   //}
-  if(s.match("} endconstant")) {
+  case Type::EndConstant: {
     return true;
   }
 
   //output "filename" [, create]
-  if(s.match("output ?*")) {
-    auto p = split(s.trimLeft("output ", 1L));
+  case Type::Output: {
+    auto p = split(o[0]);
     if(!p(0).match("\"*\"")) error("missing filename");
     string filename = {filepath(), text(p.take(0))};
     bool create = (p.size() && p(0) == "create");
@@ -93,44 +91,51 @@ auto Bass::assemble(const string& statement) -> bool {
   }
 
   //architecture name
-  if(s.match("architecture ?*")) {
-    s.trimLeft("architecture ", 1L);
-    if(s == "none") architecture = new Architecture{*this};
+  case Type::Architecture: {
+    auto& s = o[0];
+    if(s == "none") {
+      architecture = new Architecture{*this};
+      return true;
+    }
+    auto& files = findArchitecture(s);
+    if(files.plugin) {
+      auto plugin = Plugin::load(files.plugin);
+      if(!plugin) error("unable to load architecture plugin: ", files.plugin);
+      architecture = new Plugin{*this, *plugin};
+    }
+    else if(auto native = Native::create(*this, s, files.table)) architecture = native;
     else {
-      string location{Path::userData(), "bass/architectures/", s, ".arch"};
-      if(!file::exists(location)) location = {Path::program(), "architectures/", s, ".arch"};
-      if(!file::exists(location)) error("unknown architecture: ", s);
-      architecture = new Table{*this, string::read(location)};
+      auto definition = files.table ? Table::load(files.table) : nullptr;
+      if(!definition) error("unknown architecture: ", s);
+      architecture = new Table{*this, *definition};
     }
     return true;
   }
 
   //endian (lsb|msb)
-  if(s.match("endian ?*")) {
-    s.trimLeft("endian ", 1L);
-    if(s == "lsb") { endian = Endian::LSB; return true; }
-    if(s == "msb") { endian = Endian::MSB; return true; }
+  case Type::Endian: {
+    if(o[0] == "lsb") { endian = Endian::LSB; return true; }
+    if(o[0] == "msb") { endian = Endian::MSB; return true; }
     error("invalid endian mode");
+    return true;
   }
 
   //origin offset
-  if(s.match("origin ?*")) {
-    s.trimLeft("origin ", 1L);
-    origin = evaluate(s);
+  case Type::Origin: {
+    origin = evaluate(o[0]);
     seek(origin);
     return true;
   }
 
   //base offset
-  if(s.match("base ?*")) {
-    s.trimLeft("base ", 1L);
-    base = evaluate(s) - origin;
+  case Type::Base: {
+    base = evaluate(o[0]) - origin;
     return true;
   }
 
   //enqueue variable [, ...]
-  if(s.match("enqueue ?*")) {
-    auto p = split(s.trimLeft("enqueue ", 1L));
+  case Type::Enqueue: {
+    auto p = split(o[0]);
     for(auto& t : p) {
       if(t == "origin") {
         queue.append(origin);
@@ -147,8 +152,8 @@ auto Bass::assemble(const string& statement) -> bool {
   }
 
   //dequeue variable [, ...]
-  if(s.match("dequeue ?*")) {
-    auto p = split(s.trimLeft("dequeue ", 1L));
+  case Type::Dequeue: {
+    auto p = split(o[0]);
     for(auto& t : p) {
       if(t == "origin") {
         origin = queue.takeRight().natural();
@@ -167,9 +172,10 @@ auto Bass::assemble(const string& statement) -> bool {
   }
 
   //copy source, target, length
-  if(s.match("copy ?*")) {
-    auto p = split(s.trimLeft("copy ", 1L));
+  case Type::Copy: {
+    auto p = split(o[0]);
     if(p.size() == 3) {
+      replayable = false;  //reads back from the target file
       auto origin = targetFile.offset();
       auto source = evaluate(p(0));
       auto target = evaluate(p(1));
@@ -179,21 +185,23 @@ auto Bass::assemble(const string& statement) -> bool {
       targetFile.seek(source);
       targetFile.read(memory);
       targetFile.seek(target);
-      for(uint offset : range(length)) write(memory[offset]);
+      write(memory);
       targetFile.seek(origin);
       return true;
     }
+    return false;
   }
 
   //insert [name, ] filename [, offset] [, length]
-  if(s.match("insert ?*")) {
-    auto p = split(s.trimLeft("insert ", 1L));
+  case Type::Insert: {
+    auto p = split(o[0]);
     string name;
     if(!p(0).match("\"*\"")) name = p.take(0);
     if(!p(0).match("\"*\"")) error("missing filename");
     string filename = {filepath(), text(p.take(0))};
-    auto fp = file::open(filename, file::mode::read);
-    if(!fp) error("file not found: ", filename);
+    recordInput(filename);
+    file_map fp;
+    if(!file::exists(filename) || !fp.open(filename, file_map::mode::read)) error("file not found: ", filename);
     uint offset = p.size() ? evaluate(p.take(0)) : 0;
     if(offset > fp.size()) offset = fp.size();
     uint length = p.size() ? evaluate(p.take(0)) : 0;
@@ -203,14 +211,15 @@ auto Bass::assemble(const string& statement) -> bool {
       setConstant({name, ".size"}, length);
       writeSymbolLabel(pc(), name);
     }
-    fp.seek(offset);
-    while(!fp.end() && length--) write(fp.read());
+    write({fp.data() + offset, min(length, fp.size() - offset)});
     return true;
   }
 
   //delete filename
-  if(s.match("delete ?*")) {
-    auto p = split(s.trimLeft("delete ", 1L));
+  case Type::Delete: {
+    replayable = false;  //the write phase warns when the query phase already deleted the file
+    untrackedOutput = true;
+    auto p = split(o[0]);
     if(!p(0).match("\"*\"")) error("missing filename");
     string filename = {filepath(), text(p.take(0))};
     if(!file::exists(filename)) {
@@ -225,36 +234,40 @@ auto Bass::assemble(const string& statement) -> bool {
   }
 
   //fill length [, with]
-  if(s.match("fill ?*")) {
-    auto p = split(s.trimLeft("fill ", 1L));
+  case Type::Fill: {
+    auto p = split(o[0]);
     uint length = evaluate(p(0));
     uint byte = evaluate(p(1, "0"), Evaluation::Lax);
-    while(length--) write(byte);
+    fill(byte, length);
     return true;
   }
 
   //map 'char' [, value] [, length]
-  if(s.match("map ?*")) {
-    auto p = split(s.trimLeft("map ", 1L));
+  case Type::Map: {
+    auto p = split(o[0]);
     uint8_t index = evaluate(p(0));
     int64_t value = evaluate(p(1, "0"));
     int64_t length = evaluate(p(2, "1"));
     for(int n : range(length)) {
       stringTable[index + n] = value + n;
     }
+    stringTableVersion++;
     return true;
   }
 
   //d[bwldq] ("string"|variable) [, ...]
-  uint dataLength = 0;
-  if(s.beginsWith("db ")) dataLength = 1;
-  if(s.beginsWith("dw ")) dataLength = 2;
-  if(s.beginsWith("dl ")) dataLength = 3;
-  if(s.beginsWith("dd ")) dataLength = 4;
-  if(s.beginsWith("dq ")) dataLength = 8;
-  if(dataLength) {
-    s = slice(s, 3);  //remove prefix
-    auto p = split(s);
+  case Type::DataByte:
+  case Type::DataWord:
+  case Type::DataLong:
+  case Type::DataDouble:
+  case Type::DataQuad: {
+    uint dataLength = 0;
+    if(directive.type == Type::DataByte) dataLength = 1;
+    if(directive.type == Type::DataWord) dataLength = 2;
+    if(directive.type == Type::DataLong) dataLength = 3;
+    if(directive.type == Type::DataDouble) dataLength = 4;
+    if(directive.type == Type::DataQuad) dataLength = 8;
+    auto p = split(o[0]);
     for(auto& t : p) {
       if(t.match("\"*\"")) {
         t = text(t);
@@ -267,70 +280,82 @@ auto Bass::assemble(const string& statement) -> bool {
   }
 
   //ds amount
-  if(s.match("ds ?*")) {
-    s.trimLeft("ds ", 1L);
-    origin += evaluate(s);
+  case Type::Ds: {
+    origin += evaluate(o[0]);
     seek(origin);
     return true;
   }
 
-  //tracker enable|disable|reset
-  if(s.match("tracker ?*")) {
-    s.trimLeft("tracker ", 1L).strip();
-    if(s == "enable") {
-      if(writePhase()) tracker.enable = true;
+  //tracker enable|report|disable|reset
+  case Type::Tracker: {
+    replayable = false;  //overwrites are reported against the instruction that caused them
+    if(o[0] == "enable") {
+      if(writePhase()) tracker.enable = true, tracker.report = false;
+      return true;
+    }
+    if(o[0] == "report") {
+      if(writePhase()) tracker.enable = true, tracker.report = true;
       return true;
     }
-    if(s == "disable") {
+    if(o[0] == "disable") {
       if(writePhase()) tracker.enable = false;
       return true;
     }
-    if(s == "reset") {
-      if(writePhase()) tracker.addresses.reset();
+    if(o[0] == "reset") {
+      if(writePhase()) tracker.reset();
       return true;
     }
+    return false;
   }
 
   //print ("string"|[cast:]variable) [, ...]
-  if(s.match("print ?*")) {
+  case Type::Print: {
+    replayable = false;  //only evaluated by the write phase
+    untrackedOutput = true;
     if(writePhase()) {
-      s.trimLeft("print ", 1L).strip();
-      print(stderr, assembleString(s));
+      report(assembleString(o[0]));
     }
     return true;
   }
 
   //notice ("string"|[cast:]variable) [, ...]
-  if(s.match("notice ?*")) {
+  case Type::Notice: {
+    replayable = false;  //only evaluated by the write phase
     if(writePhase()) {
-      s.trimLeft("notice ", 1L).strip();
-      notice(assembleString(s));
+      notice(assembleString(o[0]));
     }
     return true;
   }
 
   //warning ("string"|[cast:]variable) [, ...]
-  if(s.match("warning ?*")) {
+  case Type::Warning: {
+    replayable = false;  //only evaluated by the write phase
     if(writePhase()) {
-      s.trimLeft("warning ", 1L).strip();
-      warning(assembleString(s));
+      warning(assembleString(o[0]));
     }
     return true;
   }
 
   //error ("string"|[cast:]variable) [, ...]
-  if(s.match("error ?*")) {
+  case Type::Error: {
+    replayable = false;  //only evaluated by the write phase
     if(writePhase()) {
-      s.trimLeft("error ", 1L).strip();
-      error(assembleString(s));
+      error(assembleString(o[0]));
     }
     return true;
   }
 
+  default: break;
+  }
+
   charactersUseMap = true;
-  bool result = architecture->assemble(statement);
+  bool result = architecture->assemble(statement.text);
   charactersUseMap = false;
-  return result;
+  if(result) return true;
+
+  //statements not recognized by the architecture are evaluated as expressions (eg variable assignments)
+  evaluate(statement.text);
+  return true;
 }
 
 auto Bass::assembleString(const string& parameters) -> string {
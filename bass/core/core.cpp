@@ -3,20 +3,32 @@
 #include "execute.cpp"
 #include "assemble.cpp"
 #include "utility.cpp"
+#include "image.cpp"
+#include "tracker.cpp"
 
 auto Bass::target(const string& filename, bool create) -> bool {
+  if(queryPhase() && replayable) emissions.append({Emission::Type::Target, create, filename});
   if(targetFile) targetFile.close();
-  if(!filename) return true;
+
+  //without a target file, output is written to stdout, unless it is a terminal
+  if(!filename) {
+    if(!isatty(fileno(stdout))) targetFile.open(stdout), untrackedOutput = true;
+    return true;
+  }
 
   //cannot modify a file unless it exists
+  if(!create) recordInput(filename);
   if(!file::exists(filename)) create = true;
+  recordOutput(filename);
 
-  if(!targetFile.open(filename, create ? file::mode::write : file::mode::modify)) {
-    print(stderr, "warning: unable to open target file: ", filename, "\n");
+  if(!targetFile.open(filename, create)) {
+    untrackedOutput = true;
+    report("warning: unable to open target file: ", filename, "\n");
     return false;
   }
+  if(writePhase()) targetFile.reserve(targetExtent);
 
-  tracker.addresses.reset();
+  tracker.reset();
   return true;
 }
 
@@ -24,65 +36,196 @@ auto Bass::symFile(const string& filename) -> bool {
   if(symbolFile) symbolFile.close();
   if(!filename) return true;
 
+  recordOutput(filename);
   if(!symbolFile.open(filename, file::mode::write)) {
-    print(stderr, "warning: unable to open symbol file: ", filename, "\n");
+    untrackedOutput = true;
+    report("warning: unable to open symbol file: ", filename, "\n");
     return false;
   }
 
   return true;
 }
 
+//source files are read and split into statements by a loader thread, which follows includes
+//ahead of the main thread. files are handed back in the order they appear in the program.
 auto Bass::source(const string& filename) -> bool {
-  if(!file::exists(filename)) {
-    print(stderr, "warning: source file not found: ", filename, "\n");
-    return false;
-  }
-
-  uint fileNumber = sourceFilenames.size();
-  sourceFilenames.append(filename);
+  auto loader = thread::create([&](uintptr) { loadSources(filename); });
+  bool found = appendSource(filename);
+  loader.join();
+  sentSources.reset();
+  return found;
+}
 
-  string data = file::read(filename);
-  data.transform("\t\r", "  ");
+//sources are memory-mapped and split into statements in place: each line is clipped at the
+//first comment marker (//), then split by any semicolons (;) not appearing inside of quotes.
+//only the resulting statements are copied out of the mapped file.
+auto Bass::readSource(const string& filename) -> shared_pointer<Source> {
+  shared_pointer<Source> source{new Source};
+
+  file_map fp;
+  if(!file::exists(filename) || !fp.open(filename, file_map::mode::read)) return source;
+  source->found = true;
+
+  auto data = (const char*)fp.data();
+  uint64_t size = fp.size();
+  uint lineNumber = 0;
+  for(uint64_t lineOffset = 0; lineOffset < size || lineNumber == 0;) {
+    auto lineEnd = (const char*)memchr(data + lineOffset, '\n', size - lineOffset);
+    uint64_t lineSize = lineEnd ? lineEnd - (data + lineOffset) : size - lineOffset;
+    const char* line = data + lineOffset;
+    lineOffset += lineSize + 1;
+    lineNumber++;
 
-  auto lines = data.split("\n");
-  for(uint lineNumber : range(lines.size())) {
     //remove single-line comments
-    if(auto position = lines[lineNumber].qfind("//")) {
-      lines[lineNumber].resize(position());
+    for(uint64_t n = 0, quoted = 0; n + 1 < lineSize; n++) {
+      if(line[n] == '"') quoted ^= 1;
+      else if(!quoted && line[n] == '/' && line[n + 1] == '/') { lineSize = n; break; }
     }
 
     //allow multiple statements per line, separated by ';'
-    auto blocks = lines[lineNumber].qsplit(";").strip();
-    for(uint blockNumber : range(blocks.size())) {
-      string statement = blocks[blockNumber];
+    uint blockNumber = 0;
+    uint64_t blockOffset = 0;
+    for(uint64_t n = 0, quoted = 0; blockOffset <= lineSize;) {
+      if(n < lineSize) {
+        if(quoted && line[n] == '\\') { n += 2; continue; }
+        if(line[n] == '\'' && quoted != 2) { quoted ^= 1; n++; continue; }
+        if(line[n] == '\"' && quoted != 1) { quoted ^= 2; n++; continue; }
+        if(quoted || line[n] != ';') { n++; continue; }
+      }
+      blockNumber++;
+      uint64_t blockBegin = blockOffset, blockEnd = min(n, lineSize);
+      blockOffset = n = blockEnd + 1;
+
+      auto space = [](char c) { return c == ' ' || c == '\t' || c == '\r'; };
+      while(blockBegin < blockEnd && space(line[blockBegin])) blockBegin++;
+      while(blockEnd > blockBegin && space(line[blockEnd - 1])) blockEnd--;
+      if(blockBegin == blockEnd) continue;
+
+      string statement;
+      statement.resize(blockEnd - blockBegin);
+      auto output = statement.get();
+      for(uint64_t m : range(blockBegin, blockEnd)) {
+        char c = line[m];
+        *output++ = c == '\t' || c == '\r' ? ' ' : c;
+      }
       strip(statement);
-      if(!statement) continue;
 
-      if(statement.match("include \"?*\"")) {
+      bool include = statement.match("include \"?*\"");
+      if(include) {
         statement.trimLeft("include ", 1L).strip();
-        source({Location::path(filename), text(statement)});
-      } else {
-        Instruction instruction;
-        instruction.statement = statement;
-        instruction.fileNumber = fileNumber;
-        instruction.lineNumber = 1 + lineNumber;
-        instruction.blockNumber = 1 + blockNumber;
-        program.append(instruction);
+        //includes holds separate copies, as string reference counts must not be shared between threads
+        source->includes.append({Location::path(filename), text(statement)});
+        statement = {Location::path(filename), text(statement)};
       }
+      source->statements.append({statement, lineNumber, blockNumber, include});
+    }
+  }
+
+  return source;
+}
+
+//runs on the loader thread: finds each source file in program order.
+//a file included again while unmodified shares the statements read the first time.
+auto Bass::loadSources(const string& filename) -> void {
+  static const Source missing;
+  if(!file::exists(filename)) return loadedSources.await_write(&missing);
+
+  shared_pointer<Source> source;
+  string path = {Path::real(filename), Location::file(filename)};
+  uint64_t modified = inode::timestamp(filename);
+  uint64_t size = file::size(filename);
+  if(auto cached = sourceCache.find({path})) {
+    if(cached().modified == modified && cached().size == size) source = cached().source;
+    else sourceCache.remove({path});
+  }
+  if(!source) {
+    if(sharedSources) source = sharedSources->find(path, modified, size);
+    if(!source) {
+      source = readSource(filename);
+      if(sharedSources) sharedSources->insert(path, modified, size, *source);
+    }
+    sourceCache.insert({path, modified, size, source});
+  }
+
+  //once written, source is only read by the main thread. it is kept alive until then,
+  //even if a later include of a modified file replaces it in the cache.
+  sentSources.append(source);
+  loadedSources.await_write(source.data());
+  for(auto& include : source->includes) loadSources(include);
+}
+
+//runs on the main thread: appends the next source file read by the loader thread to the program
+auto Bass::appendSource(const string& filename) -> bool {
+  auto source = loadedSources.await_read();
+  recordInput(filename);
+  if(!source->found) {
+    untrackedOutput = true;
+    report("warning: source file not found: ", filename, "\n");
+    return false;
+  }
+
+  uint fileNumber = sourceFilenames.size();
+  sourceFilenames.append(filename);
+
+  for(auto& statement : source->statements) {
+    if(statement.include) {
+      appendSource(statement.text);
+    } else {
+      Instruction instruction;
+      instruction.statement = statement.text;
+      instruction.fileNumber = fileNumber;
+      instruction.lineNumber = statement.lineNumber;
+      instruction.blockNumber = statement.blockNumber;
+      program.append(instruction);
     }
   }
 
   return true;
 }
 
+auto Bass::SourceCache::find(const string& path, uint64_t modified, uint64_t size) -> shared_pointer<Source> {
+  lock_guard<mutex> guard(lock);
+  if(auto cached = sources.find({path})) {
+    if(cached().modified == modified && cached().size == size) return copy(*cached().source);
+  }
+  return {};
+}
+
+auto Bass::SourceCache::insert(const string& path, uint64_t modified, uint64_t size, const Source& source) -> void {
+  lock_guard<mutex> guard(lock);
+  sources.remove({path});
+  sources.insert({string{string_view{path}}, modified, size, copy(source)});
+}
+
+//copies every string of a source, so that the copy shares no reference counts with it
+auto Bass::SourceCache::copy(const Source& source) -> shared_pointer<Source> {
+  shared_pointer<Source> result{new Source};
+  result->found = source.found;
+  result->statements.reserve(source.statements.size());
+  for(auto& statement : source.statements) {
+    result->statements.append({string{string_view{statement.text}}, statement.lineNumber, statement.blockNumber, statement.include});
+  }
+  for(auto& include : source.includes) result->includes.append(string{string_view{include}});
+  return result;
+}
+
+auto Bass::recordInput(const string& filename) -> void {
+  if(!inputFiles.find(filename)) inputFiles.append(filename);
+}
+
+auto Bass::recordOutput(const string& filename) -> void {
+  if(!outputFiles.find(filename)) outputFiles.append(filename);
+}
+
 auto Bass::define(const string& name, const string& value) -> void {
-  defines.insert({name, {}, value});
+  defines.insert({internSymbol(0, name), {}, value});
 }
 
 auto Bass::constant(const string& name, const string& value) -> void {
   try {
-    constantNames.insert(name);
-    constants.insert({name, evaluate(value, Evaluation::Strict)});
+    uint symbol = internSymbol(0, name);
+    constantNames.insert(symbol);
+    constants.insert({symbol, evaluate(value, Evaluation::Strict)});
   } catch(...) {
   }
 }
@@ -96,12 +239,29 @@ auto Bass::assemble(bool strict) -> bool {
 
     phase = Phase::Query;
     architecture = new Architecture{*this};
+    emissions.reset();
+    emissionData.reset();
+    probedConstants.reset();
+    probedNames.reset();
+    deferrals.reset();
+    replayable = true;
+    targetExtent = 0;
     execute();
 
+    //the write phase would compute the same values as the query phase, except for deferrals
     phase = Phase::Write;
     architecture = new Architecture{*this};
-    execute();
+    targetFile.reserve(targetExtent);
+    if(replayable) replay();
+    else execute();
+
+    if(tracker.overwrites) {
+      activeInstruction = nullptr;
+      error("overwrites detected: ", tracker.overwrites);
+    }
   } catch(...) {
+    //the image of a failed assembly is not written back to its target file
+    targetFile.discard();
     return false;
   }
 
@@ -115,6 +275,7 @@ auto Bass::pc() const -> uint {
 }
 
 auto Bass::seek(uint offset) -> void {
+  if(queryPhase() && replayable) emissions.append({Emission::Type::Seek, offset});
   if(!targetFile) return;
   if(writePhase()) targetFile.seek(offset);
 }
@@ -122,41 +283,220 @@ auto Bass::seek(uint offset) -> void {
 auto Bass::track(uint length) -> void {
   if(!tracker.enable) return;
   uint64_t address = targetFile.offset();
-  for(auto n : range(length)) {
-    if(tracker.addresses.find(address + n)) {
-      error("overwrite detected at address 0x", hex(address + n), " [0x", hex(base + address + n), "]");
+  uint64_t end = address + length;
+  uint64_t first = tracker.next(address, end, true);
+  if(first < end && !tracker.report) {
+    error("overwrite detected at address 0x", hex(first), " [0x", hex(base + first), "]");
+  }
+  while(first < end) {
+    //report mode lists each overwritten range, and continues assembly
+    uint64_t last = tracker.next(first, end, false) - 1;
+    auto& overwrite = tracker.overwrite;
+    if(overwrite && overwrite().last + 1 == first && overwrite().base == base) {
+      overwrite().last = last;
+    } else {
+      reportOverwrite();
+      overwrite = Tracker::Overwrite{first, last, base};
     }
-    tracker.addresses.insert(address + n);
+    first = tracker.next(last + 1, end, true);
   }
+  tracker.insert(address, length);
+}
+
+auto Bass::reportOverwrite() -> void {
+  if(!tracker.overwrite) return;
+  auto overwrite = tracker.overwrite();
+  tracker.overwrite.reset();
+
+  string addresses = {"0x", hex(overwrite.first)};
+  string mapped = {"0x", hex(overwrite.base + overwrite.first)};
+  if(overwrite.last > overwrite.first) {
+    addresses.append("-0x", hex(overwrite.last));
+    mapped.append("-0x", hex(overwrite.base + overwrite.last));
+  }
+  report(diagnostic ? string{"error: "} : terminal::color::red("error: "), "overwrite detected at address ", addresses, " [", mapped, "]\n");
+  printInstructionStack();
+  tracker.overwrites++;
 }
 
 auto Bass::write(uint64_t data, uint length) -> void {
-  if(writePhase()) {
+  if(patching) {
+    for(uint n : range(length)) {
+      uint shift = endian == Endian::LSB ? n : length - 1 - n;
+      if(patchOffset < patchLimit) emissionData[patchOffset] = data >> shift * 8;
+      patchOffset++;
+    }
+  } else if(writePhase()) {
     if(targetFile) {
       track(length);
       if(endian == Endian::LSB) targetFile.writel(data, length);
       if(endian == Endian::MSB) targetFile.writem(data, length);
-    } else if(!isatty(fileno(stdout))) {
-      if(endian == Endian::LSB) for(uint n : range(length)) fputc(data >> n * 8, stdout);
-      if(endian == Endian::MSB) for(uint n : reverse(range(length))) fputc(data >> n * 8, stdout);
+    }
+  } else if(queryPhase() && replayable) {
+    if(endian == Endian::LSB) for(uint n : range(length)) emissionData.append(data >> n * 8);
+    if(endian == Endian::MSB) for(uint n : reverse(range(length))) emissionData.append(data >> n * 8);
+  }
+  emitted(length);
+}
+
+//writes a span of bytes at once; used by insert and copy
+auto Bass::write(array_view<uint8_t> data) -> void {
+  if(patching) {
+    for(auto byte : data) write(byte);
+    return;
+  }
+
+  if(writePhase()) {
+    if(targetFile) {
+      track(data.size());
+      targetFile.write(data);
+    }
+  } else if(queryPhase() && replayable) {
+    uint offset = emissionData.size();
+    emissionData.resize(offset + data.size());
+    memory::copy(emissionData.data() + offset, data.data(), data.size());
+  }
+  emitted(data.size());
+}
+
+//writes length copies of byte at once; used by fill
+auto Bass::fill(uint8_t byte, uint length) -> void {
+  if(patching) {
+    while(length--) write(byte);
+    return;
+  }
+
+  if(writePhase()) {
+    if(targetFile) {
+      track(length);
+      targetFile.fill(byte, length);
+    }
+  } else if(queryPhase() && replayable) {
+    emissionData.resize(emissionData.size() + length, byte);
+  }
+  emitted(length);
+}
+
+//records the bytes appended to emissionData by the query phase, and advances the write address
+auto Bass::emitted(uint length) -> void {
+  if(queryPhase() && replayable) {
+    if(emissions && emissions.right().type == Emission::Type::Write) {
+      emissions.right().value += length;
+    } else {
+      emissions.append({Emission::Type::Write, length});
     }
   }
   origin += length;
+  if(queryPhase()) targetExtent = max(targetExtent, (uint64_t)origin);
 }
 
 auto Bass::writeSymbolLabel(int64_t value, const string& name) -> void {
   if(writePhase()) {
     if(symbolFile) {
-      string scopedName = {scope.merge("."), scope ? "." : "", name};
+      string scopedName = {symbolNames[scopeSymbol()], scope ? "." : "", name};
       symbolFile.print(hex(value, 8), ' ', scopedName, '\n');
     }
+  } else if(queryPhase() && replayable) {
+    if(symbolFile) {
+      string scopedName = {symbolNames[scopeSymbol()], scope ? "." : "", name};
+      emissions.append({Emission::Type::Label, (uint64_t)value, scopedName});
+    }
   }
 }
 
+//writes the output recorded by the query phase, in place of executing the program again
+auto Bass::replay() -> void {
+  try {
+    frames.append({0, false});
+    patching = true;
+    patchedConstants.reset();
+    for(auto& deferral : deferrals) patch(deferral);
+    patching = false;
+    frames.removeRight();
+  } catch(...) {
+    //execute the program again, so that any diagnostics are reported in full
+    patching = false;
+    for(auto symbol : patchedConstants) constants.remove({symbol});
+    architecture = new Architecture{*this};
+    execute();
+    return;
+  }
+
+  const uint8_t* data = emissionData.data();
+  for(auto& emission : emissions) {
+    switch(emission.type) {
+    case Emission::Type::Target:
+      target(emission.name, emission.value);
+      break;
+    case Emission::Type::Seek:
+      seek(emission.value);
+      break;
+    case Emission::Type::Write:
+      targetFile.write({data, emission.value});
+      data += emission.value;
+      break;
+    case Emission::Type::Label:
+      symbolFile.print(hex(emission.value, 8), ' ', emission.name, '\n');
+      break;
+    }
+  }
+}
+
+//records the active instruction as a deferral, when it can be assembled again in isolation
+auto Bass::defer(Instruction& i, const Statement& statement, uint directive) -> void {
+  using Type = Directive::Type;
+  auto type = statement.directives[directive].type;
+  bool supported = type == Type::Constant || type == Type::Instruction
+  || (type >= Type::DataByte && type <= Type::DataQuad);
+  if(!supported || !patchable || !context.aligned || !architecture->aligned()) {
+    replayable = false;
+    return;
+  }
+
+  Deferral deferral;
+  deferral.instruction = &i;
+  if(i.dynamic) deferral.statement = statement;
+  deferral.directive = directive;
+  deferral.offset = context.offset;
+  deferral.length = emissionData.size() - context.offset;
+  deferral.origin = context.origin;
+  deferral.base = context.base;
+  deferral.endian = context.endian;
+  deferral.lastLabelCounter = lastLabelCounter;
+  deferral.nextLabelCounter = nextLabelCounter;
+  deferral.stringTableVersion = stringTableVersion;
+  deferral.scope = scope;
+  deferral.architecture = architecture;
+  deferrals.append(deferral);
+}
+
+//assembles a deferral again, now that all constants are known, overwriting the bytes it emitted
+auto Bass::patch(Deferral& d) -> void {
+  if(d.stringTableVersion != stringTableVersion) throw PatchFailed();
+
+  auto& i = *d.instruction;
+  activeInstruction = &i;
+  statementPool.reset();
+  cacheExpressions = !i.dynamic;
+  origin = d.origin;
+  base = d.base;
+  endian = d.endian;
+  lastLabelCounter = d.lastLabelCounter;
+  nextLabelCounter = d.nextLabelCounter;
+  scope = d.scope;
+  architecture = d.architecture;
+  patchOffset = d.offset;
+  patchLimit = d.offset + d.length;
+
+  auto& statement = i.dynamic ? d.statement : i.decoded;
+  assemble(statement, statement.directives[d.directive]);
+  if(patchOffset != patchLimit || !architecture->aligned()) throw PatchFailed();
+}
+
 auto Bass::printInstruction() -> void {
   if(activeInstruction) {
     auto& i = *activeInstruction;
-    print(stderr, sourceFilenames[i.fileNumber], ":", i.lineNumber, ":", i.blockNumber, ": ", i.statement, "\n");
+    report(sourceFilenames[i.fileNumber], ":", i.lineNumber, ":", i.blockNumber, ": ", i.statement, "\n");
   }
 }
 
@@ -166,21 +506,42 @@ auto Bass::printInstructionStack() -> void {
   for(const auto& frame : reverse(frames)) {
     if(frame.ip > 0 && frame.ip <= program.size()) {
       auto& i = program[frame.ip - 1];
-      print(stderr, "   ", sourceFilenames[i.fileNumber], ":", i.lineNumber, ":", i.blockNumber, ": ", i.statement, "\n");
+      report("   ", sourceFilenames[i.fileNumber], ":", i.lineNumber, ":", i.blockNumber, ": ", i.statement, "\n");
     }
   }
 }
 
+//diagnostics passed to a callback are not colored, as they are not necessarily shown on a terminal
+template<typename... P> auto Bass::report(P&&... p) -> void {
+  string text{forward<P>(p)...};
+  if(diagnostic) return diagnostic(text);
+  print(stderr, text);
+}
+
 template<typename... P> auto Bass::notice(P&&... p) -> void {
-  string s{forward<P>(p)...};
-  print(stderr, terminal::color::gray("notice: "), s, "\n");
-  printInstructionStack();
+  if(patching) throw PatchFailed();  //replay() reports diagnostics by executing the program again
+  reportOverwrite();  //diagnostics are reported in the order they were raised
+
+  replayable = false;  //diagnostics are reported by both phases
+  untrackedOutput = true;
+  if(!quiet) {
+    string s{forward<P>(p)...};
+    report(diagnostic ? string{"notice: "} : terminal::color::gray("notice: "), s, "\n");
+    printInstructionStack();
+  }
 }
 
 template<typename... P> auto Bass::warning(P&&... p) -> void {
-  string s{forward<P>(p)...};
-  print(stderr, terminal::color::yellow("warning: "), s, "\n");
-  printInstructionStack();
+  if(patching) throw PatchFailed();  //replay() reports diagnostics by executing the program again
+  reportOverwrite();  //diagnostics are reported in the order they were raised
+
+  replayable = false;  //diagnostics are reported by both phases
+  untrackedOutput = true;
+  if(!quiet) {
+    string s{forward<P>(p)...};
+    report(diagnostic ? string{"warning: "} : terminal::color::yellow("warning: "), s, "\n");
+    printInstructionStack();
+  }
 
   if(!strict) return;
   struct BassWarning {};
@@ -188,9 +549,14 @@ template<typename... P> auto Bass::warning(P&&... p) -> void {
 }
 
 template<typename... P> auto Bass::error(P&&... p) -> void {
-  string s{forward<P>(p)...};
-  print(stderr, terminal::color::red("error: "), s, "\n");
-  printInstructionStack();
+  if(patching) throw PatchFailed();  //replay() reports diagnostics by executing the program again
+  reportOverwrite();  //diagnostics are reported in the order they were raised
+
+  if(!quiet) {
+    string s{forward<P>(p)...};
+    report(diagnostic ? string{"error: "} : terminal::color::red("error: "), s, "\n");
+    printInstructionStack();
+  }
 
   struct BassError {};
   throw BassError();
@@ -8,29 +8,43 @@ struct Bass {
   auto constant(const string& name, const string& value) -> void;
   auto assemble(bool strict = false) -> bool;
 
+  //files read and written by assembly; inputs include files that were looked for but not found
+  auto inputs() const -> const string_vector& { return inputFiles; }
+  auto outputs() const -> const string_vector& { return outputFiles; }
+  auto sideEffects() const -> bool { return untrackedOutput; }
+
+  //diagnostics are printed to stderr, unless a callback is given to receive them
+  auto onDiagnostic(const function<void (const string&)>& callback) -> void { diagnostic = callback; }
+
   enum class Phase : uint { Analyze, Query, Write };
   enum class Endian : uint { LSB, MSB };
   enum class Evaluation : uint { Strict = 0, Lax = 1 };  //strict mode disallows forward-declaration of constants
 
-  struct Instruction {
-    string statement;
-    uint ip;
+  //scoped names are interned one dot-separated component at a time:
+  //each scoped name has a stable ID, found from the ID of its scope and its final component
+  struct Symbol {
+    Symbol() {}
+    Symbol(uint scope, const string& name) : scope(scope), name(name), nameHash(name.hash()) {}
 
-    uint fileNumber;
-    uint lineNumber;
-    uint blockNumber;
+    auto hash() const -> uint { return scope * 0x9e3779b1 ^ nameHash; }
+    auto operator==(const Symbol& source) const -> bool { return scope == source.scope && name == source.name; }
+
+    uint scope;     //ID of the enclosing scoped name (0 = root scope)
+    string name;    //final component of the scoped name
+    uint nameHash;  //hash of name; kept so that probing several scopes only hashes name once
+    uint id;
   };
 
   struct Macro {
     Macro() {}
-    Macro(const string& name) : name(name) {}
-    Macro(const string& name, const string_vector& parameters, uint ip, bool inlined) : name(name), parameters(parameters), ip(ip), inlined(inlined) {}
+    Macro(uint symbol) : symbol(symbol) {}
+    Macro(uint symbol, const string_vector& parameters, uint ip, bool inlined) : symbol(symbol), parameters(parameters), ip(ip), inlined(inlined) {}
 
-    auto hash() const -> uint { return name.hash(); }
-    auto operator==(const Macro& source) const -> bool { return name == source.name; }
-    auto operator< (const Macro& source) const -> bool { return name <  source.name; }
+    auto hash() const -> uint { return symbol; }
+    auto operator==(const Macro& source) const -> bool { return symbol == source.symbol; }
+    auto operator< (const Macro& source) const -> bool { return symbol <  source.symbol; }
 
-    string name;
+    uint symbol;
     string_vector parameters;
     uint ip;
     bool inlined;
@@ -38,14 +52,14 @@ struct Bass {
 
   struct Define {
     Define() {}
-    Define(const string& name) : name(name) {}
-    Define(const string& name, const string_vector& parameters, const string& value) : name(name), parameters(parameters), value(value) {}
+    Define(uint symbol) : symbol(symbol) {}
+    Define(uint symbol, const string_vector& parameters, const string& value) : symbol(symbol), parameters(parameters), value(value) {}
 
-    auto hash() const -> uint { return name.hash(); }
-    auto operator==(const Define& source) const -> bool { return name == source.name; }
-    auto operator< (const Define& source) const -> bool { return name <  source.name; }
+    auto hash() const -> uint { return symbol; }
+    auto operator==(const Define& source) const -> bool { return symbol == source.symbol; }
+    auto operator< (const Define& source) const -> bool { return symbol <  source.symbol; }
 
-    string name;
+    uint symbol;
     string_vector parameters;
     string value;
   };
@@ -54,14 +68,14 @@ struct Bass {
 
   struct Variable {
     Variable() {}
-    Variable(const string& name) : name(name) {}
-    Variable(const string& name, int64_t value) : name(name), value(value) {}
+    Variable(uint symbol) : symbol(symbol) {}
+    Variable(uint symbol, int64_t value) : symbol(symbol), value(value) {}
 
-    auto hash() const -> uint { return name.hash(); }
-    auto operator==(const Variable& source) const -> bool { return name == source.name; }
-    auto operator< (const Variable& source) const -> bool { return name <  source.name; }
+    auto hash() const -> uint { return symbol; }
+    auto operator==(const Variable& source) const -> bool { return symbol == source.symbol; }
+    auto operator< (const Variable& source) const -> bool { return symbol <  source.symbol; }
 
-    string name;
+    uint symbol;
     int64_t value;
   };
 
@@ -69,17 +83,29 @@ struct Bass {
 
   struct Array {
     Array() {}
-    Array(const string& name) : name(name) {}
-    Array(const string& name, vector<int64_t> values) : name(name), values(values) {}
+    Array(uint symbol) : symbol(symbol) {}
+    Array(uint symbol, vector<int64_t> values) : symbol(symbol), values(values) {}
 
-    auto hash() const -> uint { return name.hash(); }
-    auto operator==(const Array& source) const -> bool { return name == source.name; }
-    auto operator< (const Array& source) const -> bool { return name <  source.name; }
+    auto hash() const -> uint { return symbol; }
+    auto operator==(const Array& source) const -> bool { return symbol == source.symbol; }
+    auto operator< (const Array& source) const -> bool { return symbol <  source.symbol; }
 
-    string name;
+    uint symbol;
     vector<int64_t> values;
   };
 
+  struct ParsedExpression {
+    ParsedExpression() {}
+    ParsedExpression(const string& text) : text(text) {}
+    ParsedExpression(const string& text, Eval::Node* node) : text(text), node(node) {}
+
+    auto hash() const -> uint { return text.hash(); }
+    auto operator==(const ParsedExpression& source) const -> bool { return text == source.text; }
+
+    string text;
+    Eval::Node* node = nullptr;
+  };
+
   struct Frame {
     enum class Level : uint {
       Inline,  //use deepest frame (eg for parameters)
@@ -98,36 +124,229 @@ struct Bass {
     hashset<Array> arrays;
   };
 
+  struct Directive {
+    //listed in matching order: a statement is decoded as the first directive whose pattern it matches
+    enum class Type : uint {
+      //execute.cpp
+      Macro, Inline, DefineFunction, Define, Evaluate, ExpressionFunction, Variable, Array, ArrayAssign,
+      InvalidFrame, If, ElseIf, Else, EndIf, While, EndWhile, Invoke, EndMacro,
+      //assemble.cpp
+      Block, EndBlock, Namespace, EndNamespace, Function, EndFunction, Constant, Label, LastLabel, NextLabel, EndConstant,
+      Output, Architecture, Endian, Origin, Base, Enqueue, Dequeue, Copy, Insert, Delete, Fill, Map,
+      DataByte, DataWord, DataLong, DataDouble, DataQuad, Ds, Tracker, Print, Notice, Warning, Error,
+      Instruction,  //passed to the active architecture
+    } type;
+    string_vector operands;
+  };
+
+  struct Statement {
+    string text;                   //statement with any frame specifier removed
+    Frame::Level level;            //frame specified by a global or parent prefix
+    vector<Directive> directives;  //matching directives; all but the last may decline the statement
+  };
+
+  struct Instruction {
+    string statement;
+    uint ip;
+
+    uint fileNumber;
+    uint lineNumber;
+    uint blockNumber;
+
+    bool dynamic;       //statement contains {define} substitutions, and must be decoded during execution
+    Statement decoded;  //statement decoded by the analyze phase when not dynamic
+  };
+
   struct Block {
     uint ip;
     string type;
   };
 
+  //a source file, split into statements by readSource()
+  struct Source {
+    struct Statement {
+      string text;  //filename when include is set
+      uint lineNumber;
+      uint blockNumber;
+      bool include;
+    };
+
+    bool found = false;
+    vector<Statement> statements;
+    string_vector includes;  //only used by the loader thread
+  };
+
+  struct CachedSource {
+    CachedSource() {}
+    CachedSource(const string& path) : path(path) {}
+    CachedSource(const string& path, uint64_t modified, uint64_t size, shared_pointer<Source> source) : path(path), modified(modified), size(size), source(source) {}
+
+    auto hash() const -> uint { return path.hash(); }
+    auto operator==(const CachedSource& source) const -> bool { return path == source.path; }
+
+    string path;  //canonical filename
+    uint64_t modified;
+    uint64_t size;
+    shared_pointer<Source> source;
+  };
+
+  //source files kept between assemblies, which may run on several threads at once (see --serve).
+  //sources are copied into and out of the cache, as string reference counts are not thread-safe.
+  struct SourceCache {
+    auto find(const string& path, uint64_t modified, uint64_t size) -> shared_pointer<Source>;
+    auto insert(const string& path, uint64_t modified, uint64_t size, const Source& source) -> void;
+
+  private:
+    static auto copy(const Source& source) -> shared_pointer<Source>;
+
+    mutex lock;
+    hashset<CachedSource> sources;
+  };
+
+  //files found for an architecture name; each name is looked for once per assembly
+  struct ArchitectureFiles {
+    ArchitectureFiles() {}
+    ArchitectureFiles(const string& name) : name(name) {}
+
+    auto hash() const -> uint { return name.hash(); }
+    auto operator==(const ArchitectureFiles& source) const -> bool { return name == source.name; }
+
+    string name;
+    string plugin;  //location of the plugin, if any
+    string table;   //location of the table file, if any
+  };
+
+  //source files are read from the shared cache, and added to it
+  auto share(SourceCache& cache) -> void { sharedSources = &cache; }
+
+  //written addresses are tracked in a bitmap, allocated in pages of 64 KiB
   struct Tracker {
+    auto reset() -> void { pages.reset(); }
+    auto insert(uint64_t address, uint64_t length) -> void;
+    auto next(uint64_t address, uint64_t end, bool written) const -> uint64_t;
+
+    //overwritten range not yet reported. ranges overwritten one after another (eg by the items
+    //of a single db) are extended, and reported once the instruction writing them completes.
+    struct Overwrite {
+      uint64_t first;
+      uint64_t last;
+      int base;
+    };
+
     bool enable = false;
-    set<int64_t> addresses;
+    bool report = false;  //report every overwritten range, and fail once assembly completes
+    uint overwrites = 0;  //number of ranges reported
+    maybe<Overwrite> overwrite;
+
+  private:
+    vector<vector<uint64_t>> pages;
+  };
+
+  //the target file is assembled in memory, and written back to disk once when it is closed
+  struct Image {
+    Image() = default;
+    Image(const Image&) = delete;
+    auto operator=(const Image&) -> Image& = delete;
+    ~Image() { close(); }
+
+    explicit operator bool() const { return (bool)handle; }
+
+    auto open(const string& filename, bool create) -> bool;
+    auto open(FILE* stream) -> bool;
+    auto close() -> void;
+    auto discard() -> void;
+    auto reserve(uint64_t size) -> void;
+    auto seek(uint64_t offset) -> void;
+    auto offset() const -> uint64_t { return position; }
+    auto size() const -> uint64_t { return data.size(); }
+    auto read() -> uint8_t;
+    auto read(array_span<uint8_t> memory) -> void;
+    auto write(uint8_t byte) -> void;
+    auto write(array_view<uint8_t> memory) -> void;
+    auto fill(uint8_t byte, uint64_t length) -> void;
+    auto writel(uint64_t value, uint length) -> void;
+    auto writem(uint64_t value, uint length) -> void;
+
+  private:
+    FILE* handle = nullptr;
+    bool stream = false;  //handle cannot seek; the whole image is written to it when closed
+    vector<uint8_t> data;
+    uint64_t position = 0;
+    uint64_t dirtyBegin = ~0ull;  //range of data modified since the file was opened
+    uint64_t dirtyEnd = 0;
   };
 
+  //output of the query phase, recorded so that the write phase may replay it
+  struct Emission {
+    enum class Type : uint { Target, Seek, Write, Label } type;
+    uint64_t value;  //Target: create flag; Seek: offset; Write: length; Label: value
+    string name;     //Target: filename; Label: scoped name
+  };
+
+  //an instruction of the query phase that evaluated forward references:
+  //the write phase assembles it again within the same context to patch the bytes it emitted
+  struct Deferral {
+    Instruction* instruction;
+    Statement statement;  //only used when the instruction is dynamic
+    uint directive;       //index of the directive that accepted the statement
+    uint offset;          //position of the emitted bytes within emissionData
+    uint length;
+    uint origin;
+    int base;
+    Endian endian;
+    uint lastLabelCounter;
+    uint nextLabelCounter;
+    uint stringTableVersion;
+    vector<uint> scope;
+    shared_pointer<Architecture> architecture;
+  };
+
+  //the context in which the active instruction began executing during the query phase
+  struct Context {
+    uint offset;
+    uint origin;
+    int base;
+    Endian endian;
+    bool aligned;
+  };
+
+  //thrown when a deferral cannot be patched
+  struct PatchFailed {};
+
 protected:
   auto analyzePhase() const -> bool { return phase == Phase::Analyze; }
   auto queryPhase() const -> bool { return phase == Phase::Query; }
   auto writePhase() const -> bool { return phase == Phase::Write; }
 
   //core.cpp
+  auto readSource(const string& filename) -> shared_pointer<Source>;
+  auto loadSources(const string& filename) -> void;
+  auto appendSource(const string& filename) -> bool;
+  auto recordInput(const string& filename) -> void;
+  auto recordOutput(const string& filename) -> void;
   auto pc() const -> uint;
   auto seek(uint offset) -> void;
   auto track(uint length) -> void;
+  auto reportOverwrite() -> void;
   auto write(uint64_t data, uint length = 1) -> void;
+  auto write(array_view<uint8_t> data) -> void;
+  auto fill(uint8_t byte, uint length) -> void;
+  auto emitted(uint length) -> void;
   auto writeSymbolLabel(int64_t value, const string& name) -> void;
+  auto replay() -> void;
+  auto defer(Instruction& instruction, const Statement& statement, uint directive) -> void;
+  auto patch(Deferral& deferral) -> void;
 
   auto printInstruction() -> void;
   auto printInstructionStack() -> void;
+  template<typename... P> auto report(P&&... p) -> void;
   template<typename... P> auto notice(P&&... p) -> void;
   template<typename... P> auto warning(P&&... p) -> void;
   template<typename... P> auto error(P&&... p) -> void;
 
   //evaluate.cpp
   auto evaluate(const string& expression, Evaluation mode = Evaluation::Strict) -> int64_t;
+  auto parseExpression(const string& expression) -> Eval::Node*;
   auto evaluate(Eval::Node* node, Evaluation mode) -> int64_t;
   auto quantifyParameters(Eval::Node* node) -> int64_t;
   auto evaluateParameters(Eval::Node* node, Evaluation mode) -> vector<int64_t>;
@@ -140,17 +359,28 @@ protected:
   //analyze.cpp
   auto analyze() -> bool;
   auto analyzeInstruction(Instruction& instruction) -> bool;
+  auto decode(const string& statement) -> Statement;
+  auto decodeDirective(const Statement& statement, Directive::Type from) -> Directive;
 
   //execute.cpp
   auto execute() -> bool;
   auto executeInstruction(Instruction& instruction) -> bool;
+  auto executeDirective(Instruction& instruction, const Statement& statement, const Directive& directive) -> bool;
 
   //assemble.cpp
   auto initialize() -> void;
-  auto assemble(const string& statement) -> bool;
+  auto assemble(const Statement& statement, const Directive& directive) -> bool;
   auto assembleString(const string& parameters) -> string;
 
   //utility.cpp
+  auto internSymbol(uint scope, const string& name) -> uint;
+  auto findSymbol(uint scope, const string& name) -> maybe<uint>;
+  auto pushScope(const string& name) -> void;
+  auto popScope() -> void;
+  auto scopeSymbol() const -> uint;
+  auto findSymbols(const string& name) -> const vector<uint>&;
+  auto findArchitecture(const string& name) -> const ArchitectureFiles&;
+
   auto setMacro(const string& name, const string_vector& parameters, uint ip, bool inlined, Frame::Level level) -> void;
   auto findMacro(const string& name) -> maybe<Macro&>;
 
@@ -167,6 +397,8 @@ protected:
   auto setConstant(const string& name, int64_t value) -> void;
   auto findConstant(const string& name) -> maybe<Constant&>;
   auto findConstantName(const string& name) -> maybe<string>;
+  auto probeConstant(uint scope, const string& name) -> void;
+  auto probedConstant(uint symbol) -> bool;
 
   auto setArray(const string& name, const vector<int64_t>& values, Frame::Level level) -> void;
   auto findArray(const string& name) -> maybe<Array&>;
@@ -185,14 +417,21 @@ protected:
   vector<Instruction> program;    //parsed source code statements
   vector<Block> blocks;           //track the start and end of blocks
   set<Define> defines;            //defines specified on the terminal
-  hashset<string> constantNames;  //set of constant names, including those with unknown values
+  hashset<Symbol> symbols;        //interned scoped names
+  string_vector symbolNames{""};  //scoped name of each symbol ID; 0 is the root scope
+  vector<uint> symbolMatches;     //used by findSymbols: IDs of a name within each enclosing scope
+  set<uint> constantNames;        //set of constant symbols, including those with unknown values
   hashset<Constant> constants;    //constants support forward-declaration
+  hashset<ParsedExpression> parsedExpressions;  //parse trees shared by every phase of assembly
+  Eval::Pool expressionPool;      //owns the nodes of parsedExpressions
+  Eval::Pool statementPool;       //owns the nodes of uncached expressions; reset after each instruction
+  bool cacheExpressions = true;   //false when the active statement was modified by define substitution
   vector<Frame> frames;           //macros, defines and variables do not
   vector<bool> conditionals;      //track conditional matching
   string_vector queue;            //track enqueue, dequeue directives
-  string_vector scope;            //track scope recursion
+  vector<uint> scope;             //track scope recursion; symbol of each enclosing scope
   int64_t stringTable[256];       //overrides for d[bwldq] text strings
-  Phase phase;                    //phase of assembly
+  Phase phase = Phase::Analyze;   //phase of assembly
   Endian endian = Endian::LSB;    //used for multi-byte writes (d[bwldq], etc)
   Tracker tracker;                //used to track writes to detect overwrites
   uint macroInvocationCounter;    //used for {#} support
@@ -203,12 +442,38 @@ protected:
   uint nextLabelCounter = 1;      //+ instance counter
   bool charactersUseMap = false;  //0 = '*' parses as ASCII; 1 = '*' uses stringTable[]
   bool strict = false;            //upgrade warnings to errors when true
+  bool quiet = false;             //diagnostics are raised without being printed (used by --verify-arch)
+  function<void (const string&)> diagnostic;  //receives diagnostics in place of stderr
 
   bool forwardReference = false;  //true if the last evaluate(string) call contained a forward reference
 
-  file_buffer targetFile;
+  vector<Emission> emissions;     //output recorded by the query phase
+  vector<uint8_t> emissionData;   //bytes written by the query phase
+  set<uint> probedConstants;      //constant symbols looked up by the query phase before being declared
+  hashset<Symbol> probedNames;    //as above, for names not yet interned: the deepest existing scope, and the rest of the name
+  bool replayable = false;        //false once the query phase output may differ from that of the write phase
+  vector<Deferral> deferrals;     //instructions to assemble again before replaying emissions
+  Context context;                //used to record deferrals
+  bool deferred = false;          //the active instruction evaluated a forward reference
+  bool patchable = true;          //the active instruction depends only upon constants and its context
+  bool patching = false;          //deferrals are being assembled again into emissionData
+  uint patchOffset = 0;           //position within emissionData written by the active deferral
+  uint patchLimit = 0;            //end of the bytes emitted by the active deferral
+  vector<uint> patchedConstants;  //constants declared by deferrals, removed if patching fails
+  uint stringTableVersion = 0;    //incremented by each map directive
+
+  Image targetFile;
+  uint64_t targetExtent = 0;      //largest target file offset reached by the query phase
   file_buffer symbolFile;
   string_vector sourceFilenames;
+  string_vector inputFiles;       //files read, or probed for, during assembly
+  string_vector outputFiles;      //target and symbol files written
+  bool untrackedOutput = false;   //output was also written to stdout or stderr, or files were deleted
+  queue_spsc<const Source*[64]> loadedSources;  //source files found by the loader thread, in program order
+  hashset<CachedSource> sourceCache;            //source files read by the loader thread
+  vector<shared_pointer<Source>> sentSources;   //keeps source files handed to the main thread alive until it is done
+  SourceCache* sharedSources = nullptr;         //source files kept between assemblies
+  hashset<ArchitectureFiles> architectureFiles;  //architectures selected by this assembly
 
   shared_pointer<Architecture> architecture;
   friend class Architecture;
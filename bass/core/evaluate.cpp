@@ -8,19 +8,30 @@ auto Bass::evaluate(const string& expression, Evaluation mode) -> int64_t {
   if(expression == "++") name = {"nextLabel#", nextLabelCounter + 1};
   if(name) {
     if(auto constant = findConstant({name()})) return constant().value;
-    if(queryPhase()) return pc();
+    if(queryPhase()) { deferred = true; return pc(); }
     error("relative label not declared");
   }
 
+  return evaluate(parseExpression(expression), mode);
+}
+
+//parse trees only depend upon the expression text, so they are cached and reused
+//by both the query and write phases, as well as by every iteration of a loop.
+//statements rewritten by define substitution tend to produce unique expressions,
+//so those are parsed into statementPool instead to keep the cache bounded.
+auto Bass::parseExpression(const string& expression) -> Eval::Node* {
+  if(auto parsed = parsedExpressions.find({expression})) return parsed().node;
+
   Eval::Node* node = nullptr;
   try {
-    node = Eval::parse(expression);
+    node = Eval::parse(expression, cacheExpressions ? expressionPool : statementPool);
   } catch(const char* reason) {
     error("malformed expression: ", expression, " [", reason, "]");
   } catch(...) {
     error("malformed expression: ", expression);
   }
-  return evaluate(node, mode);
+  if(cacheExpressions) parsedExpressions.insert({expression, node});
+  return node;
 }
 
 auto Bass::evaluate(Eval::Node* node, Evaluation mode) -> int64_t {
@@ -82,6 +93,7 @@ auto Bass::evaluateExpression(Eval::Node* node, Evaluation mode) -> int64_t {
   if(auto parameters = quantifyParameters(node->link[1])) name.append("#", parameters);
 
   if(name == "array.size#1") {
+    patchable = false;
     string s = evaluateString(node->link[1]);
     if(auto array = findArray(s)) {
       return array->values.size();
@@ -90,6 +102,7 @@ auto Bass::evaluateExpression(Eval::Node* node, Evaluation mode) -> int64_t {
     return 0;
   }
   if(name == "array.sort#1") {
+    patchable = false;
     string s = evaluateString(node->link[1]);
     if(auto array = findArray(s)) {
       array->values.sort();
@@ -106,6 +119,7 @@ auto Bass::evaluateExpression(Eval::Node* node, Evaluation mode) -> int64_t {
   if(name == "file.size#1") {
     string filename = evaluateString(node->link[1]).trim("\"", "\"", 1L);
     string location = {filepath(), filename};
+    recordInput(location);
     if(file::exists(location)) return file::size(location);
     error("file not found: ", filename);
     return 0;
@@ -113,10 +127,12 @@ auto Bass::evaluateExpression(Eval::Node* node, Evaluation mode) -> int64_t {
   if(name == "file.exists#1") {
     string filename = evaluateString(node->link[1]).trim("\"", "\"", 1L);
     string location = {filepath(), filename};
+    recordInput(location);
     return file::exists(location);
   }
   if(name == "read#1") {
     if(!targetFile) error("no target file open for reading");
+    replayable = false;  //the query phase reads back data the write phase has not written yet
     int64_t address = evaluate(node->link[1], mode);
     auto origin = targetFile.offset();
     targetFile.seek(address);
@@ -129,6 +145,7 @@ auto Bass::evaluateExpression(Eval::Node* node, Evaluation mode) -> int64_t {
   if(name == "pc") return pc();
 
   if(auto expression = findExpression(name)) {
+    patchable = false;
     auto parameters = evaluateParameters(node->link[1], mode);
     if(parameters) frames.append({0, true});
     for(auto n : range(parameters.size())) {
@@ -168,10 +185,11 @@ auto Bass::evaluateLiteral(Eval::Node* node, Evaluation mode) -> int64_t {
   if(s[0] == '$') return toHex(s);
   if(s.match("'?*'")) return character(s);
 
-  if(auto variable = findVariable(s)) return variable().value;
+  if(auto variable = findVariable(s)) return patchable = false, variable().value;
   if(auto constant = findConstant(s)) return constant().value;
 
   forwardReference = true;
+  deferred = true;
   if(mode == Evaluation::Lax && queryPhase()) return pc();
 
   if(auto constantName = findConstantName(s)) {
@@ -184,6 +202,7 @@ auto Bass::evaluateLiteral(Eval::Node* node, Evaluation mode) -> int64_t {
 
 auto Bass::evaluateSubscript(Eval::Node* node, Evaluation mode) -> int64_t {
   string& s = node->link[0]->literal;
+  patchable = false;
 
   if(auto array = findArray(s)) {
     auto index = evaluate(node->link[1], mode);
@@ -199,6 +218,7 @@ auto Bass::evaluateSubscript(Eval::Node* node, Evaluation mode) -> int64_t {
 
 auto Bass::evaluateAssign(Eval::Node* node, Evaluation mode) -> int64_t {
   string& s = node->link[0]->literal;
+  patchable = false;
 
   if(auto variable = findVariable(s)) {
     variable().value = evaluate(node->link[1], mode);
@@ -8,7 +8,7 @@ auto Bass::execute() -> bool {
 
   frames.append({0, false});
   for(auto& define : defines) {
-    setDefine(define.name, {}, define.value, Frame::Level::Inline);
+    setDefine(symbolNames[define.symbol], {}, define.value, Frame::Level::Inline);
   }
 
   while(ip < program.size()) {
@@ -22,105 +22,107 @@ auto Bass::execute() -> bool {
 
 auto Bass::executeInstruction(Instruction& i) -> bool {
   activeInstruction = &i;
-  string s = i.statement;
-  evaluateDefines(s);
-
-  bool global = s.beginsWith("global ");
-  bool parent = s.beginsWith("parent ");
-  if(global && parent) error("multiple frame specifiers are not allowed");
-
-  Frame::Level level = Frame::Level::Active;
-  if(global) s.trimLeft("global ", 1L), level = Frame::Level::Global;
-  if(parent) s.trimLeft("parent ", 1L), level = Frame::Level::Parent;
-
-  if(s.match("macro ?*(*) {")) {
-    bool inlined = false;
-    s.trim("macro ", ") {", 1L);
-    auto p = s.split("(", 1L).strip();
-    auto parameters = split(p(1));
-    setMacro(p(0), parameters, ip, inlined, level);
-    ip = i.ip;
-    return true;
+  statementPool.reset();
+
+  cacheExpressions = true;
+  Statement dynamic;
+  if(i.dynamic) {
+    string s = i.statement;
+    cacheExpressions = false;
+    evaluateDefines(s);
+    cacheExpressions = s == i.statement;
+    dynamic = decode(s);
+  }
+
+  if(queryPhase() && replayable) {
+    context = {(uint)emissionData.size(), origin, base, endian, architecture->aligned()};
+    deferred = false;
+    patchable = true;
+  }
+
+  auto& statement = i.dynamic ? dynamic : i.decoded;
+  for(uint n : range(statement.directives.size())) {
+    if(executeDirective(i, statement, statement.directives[n])) {
+      if(queryPhase() && replayable && deferred) defer(i, statement, n);
+      reportOverwrite();
+      return true;
+    }
   }
+  return false;
+}
 
-  if(s.match("inline ?*(*) {")) {
-    bool inlined = true;
-    s.trim("inline ", ") {", 1L);
-    auto p = s.split("(", 1L).strip();
-    auto parameters = split(p(1));
-    setMacro(p(0), parameters, ip, inlined, level);
+auto Bass::executeDirective(Instruction& i, const Statement& statement, const Directive& directive) -> bool {
+  using Type = Directive::Type;
+  auto& o = directive.operands;
+  auto level = statement.level;
+
+  switch(directive.type) {
+  case Type::Macro:
+  case Type::Inline: {
+    bool inlined = directive.type == Type::Inline;
+    auto parameters = split(o[1]);
+    setMacro(o[0], parameters, ip, inlined, level);
     ip = i.ip;
     return true;
   }
 
-  if(s.match("define ?*(*)*")) {
-    auto e = s.trimLeft("define ", 1L).split("=", 1L).strip();
-    auto p = e(0).trimRight(")", 1L).split("(", 1L).strip();
-    auto parameters = split(p(1));
-    setDefine(p(0), parameters, e(1), level);
+  case Type::DefineFunction: {
+    auto parameters = split(o[1]);
+    setDefine(o[0], parameters, o[2], level);
     return true;
   }
 
-  if(s.match("define ?*")) {
-    auto p = s.trimLeft("define ", 1L).split("=", 1L).strip();
-    setDefine(p(0), {}, p(1), level);
+  case Type::Define: {
+    setDefine(o[0], {}, o[1], level);
     return true;
   }
 
-  if(s.match("evaluate ?*")) {
-    auto p = s.trimLeft("evaluate ", 1L).split("=", 1L).strip();
-    setDefine(p(0), {}, evaluate(p(1)), level);
+  case Type::Evaluate: {
+    setDefine(o[0], {}, evaluate(o[1]), level);
     return true;
   }
 
-  if(s.match("expression ?*(*)*")) {
-    auto e = s.trimLeft("expression ", 1L).split("=", 1L).strip();
-    auto p = e(0).trimRight(")", 1L).split("(", 1L).strip();
-    auto parameters = split(p(1));
-    setExpression(p(0), parameters, e(1), level);
+  case Type::ExpressionFunction: {
+    auto parameters = split(o[1]);
+    setExpression(o[0], parameters, o[2], level);
     return true;
   }
 
-  if(s.match("variable ?*")) {
-    auto p = s.trimLeft("variable ", 1L).split("=", 1L).strip();
-    setVariable(p(0), evaluate(p(1)), level);
+  case Type::Variable: {
+    setVariable(o[0], evaluate(o[1]), level);
     return true;
   }
 
-  if(s.match("array[?*] ?*")) {
-    auto a = s.trimLeft("array[", 1L).split("]", 1L);
-    auto size = evaluate(a(0));
-    auto p = a(1).split("=", 1L).strip();
-    auto parameters = split(p(1));
+  case Type::Array: {
+    auto size = evaluate(o[0]);
+    auto parameters = split(o[2]);
     vector<int64_t> values;
     for(auto& parameter : parameters) values.append(evaluate(parameter));
     if(values.size() > size) error("too many array elements: ", values.size(), " > ", size);
     values.resize(size);  //zero-initialize additional elements
-    setArray(p(0), values, level);
+    setArray(o[1], values, level);
     return true;
   }
 
-  //evaluate() will evaluate array[index] to a value prior to evaluating =
-  //as a result, array[index] assignment must be manually captured early
-  if(s.match("?*[?*] = ?*")) {
-    auto a = s.split("[", 1L).strip();
-    auto b = a(1).split("]", 1L).strip();
-    auto c = b(1).split("=", 1L).strip();
-    if(auto array = findArray(a(0))) {
-      auto index = evaluate(b(0));
+  case Type::ArrayAssign: {
+    if(auto array = findArray(o[0])) {
+      auto index = evaluate(o[1]);
       if(index >= array->values.size()) error("array subscript out of bounds: ", index, " >= ", array->values.size());
-      auto value = evaluate(c(1));
+      auto value = evaluate(o[2]);
       array->values[index] = value;
       return true;
     }
     //fallthrough: this may have matched another expression that wasn't an array[index] assignment
+    return false;
   }
 
-  if(global || parent) error("invalid frame specifier");
+  case Type::InvalidFrame: {
+    error("invalid frame specifier");
+    return true;
+  }
 
-  if(s.match("if ?* {")) {
-    s.trim("if ", " {", 1L).strip();
-    bool match = evaluate(s, Evaluation::Strict);
+  case Type::If: {
+    bool match = evaluate(o[0], Evaluation::Strict);
     conditionals.append(match);
     if(match == false) {
       ip = i.ip;
@@ -128,12 +130,11 @@ auto Bass::executeInstruction(Instruction& i) -> bool {
     return true;
   }
 
-  if(s.match("} else if ?* {")) {
+  case Type::ElseIf: {
     if(conditionals.right()) {
       ip = i.ip;
     } else {
-      s.trim("} else if ", " {", 1L).strip();
-      bool match = evaluate(s, Evaluation::Strict);
+      bool match = evaluate(o[0], Evaluation::Strict);
       conditionals.right() = match;
       if(match == false) {
         ip = i.ip;
@@ -142,7 +143,7 @@ auto Bass::executeInstruction(Instruction& i) -> bool {
     return true;
   }
 
-  if(s.match("} else {")) {
+  case Type::Else: {
     if(conditionals.right()) {
       ip = i.ip;
     } else {
@@ -151,31 +152,29 @@ auto Bass::executeInstruction(Instruction& i) -> bool {
     return true;
   }
 
-  if(s.match("} endif")) {
+  case Type::EndIf: {
     conditionals.removeRight();
     return true;
   }
 
-  if(s.match("while ?* {")) {
-    s.trim("while ", " {", 1L).strip();
-    bool match = evaluate(s, Evaluation::Strict);
+  case Type::While: {
+    bool match = evaluate(o[0], Evaluation::Strict);
     if(match == false) ip = i.ip;
     return true;
   }
 
-  if(s.match("} endwhile")) {
+  case Type::EndWhile: {
     ip = i.ip;
     return true;
   }
 
-  if(s.match("?*(*)")) {
-    auto p = string{s}.trimRight(")", 1L).split("(", 1L).strip();
-    auto name = p(0);
-    auto parameters = split(p(1));
+  case Type::Invoke: {
+    auto name = o[0];
+    auto parameters = split(o[1]);
     if(parameters) name.append("#", parameters.size());
     if(auto macro = findMacro({name})) {
       frames.append({ip, macro().inlined});
-      if(!frames.right().inlined) scope.append(p(0));
+      if(!frames.right().inlined) pushScope(o[0]);
 
       setDefine("#", {}, {"_", macroInvocationCounter++, "_"}, Frame::Level::Inline);
       for(uint n : range(parameters.size())) {
@@ -193,19 +192,18 @@ auto Bass::executeInstruction(Instruction& i) -> bool {
       ip = macro().ip;
       return true;
     }
+    return false;
   }
 
-  if(s.match("} endmacro") || s.match("} endinline")) {
+  case Type::EndMacro: {
     ip = frames.right().ip;
-    if(!frames.right().inlined) scope.removeRight();
+    if(!frames.right().inlined) popScope();
     frames.removeRight();
     return true;
   }
 
-  if(assemble(s)) {
-    return true;
+  default: break;
   }
 
-  evaluate(s);
-  return true;
+  return assemble(statement, directive);
 }
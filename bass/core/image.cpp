@@ -0,0 +1,124 @@
+//the file is opened (and created or truncated) immediately, so that errors are reported as before
+auto Bass::Image::open(const string& filename, bool create) -> bool {
+  close();
+
+  #if defined(API_POSIX)
+  handle = fopen(filename, create ? "wb+" : "rb+");
+  #elif defined(API_WINDOWS)
+  handle = _wfopen(utf16_t(filename), create ? L"wb+" : L"rb+");
+  #endif
+  if(!handle) return false;
+  stream = false;
+
+  fseek(handle, 0, SEEK_END);
+  uint64_t size = ftell(handle);
+  fseek(handle, 0, SEEK_SET);
+  data.reset();
+  data.resize(size);
+  if(size) (void)fread(data.data(), 1, size, handle);
+  position = 0;
+  dirtyBegin = ~0ull;
+  dirtyEnd = 0;
+  return true;
+}
+
+//an empty image is staged for a stream, so that origin may still seek backward within it
+auto Bass::Image::open(FILE* stream) -> bool {
+  close();
+
+  handle = stream;
+  this->stream = true;
+  data.reset();
+  position = 0;
+  dirtyBegin = ~0ull;
+  dirtyEnd = 0;
+  return true;
+}
+
+auto Bass::Image::close() -> void {
+  if(!handle) return;
+  if(stream) {
+    (void)fwrite(data.data(), 1, data.size(), handle);
+    fflush(handle);
+  } else {
+    if(dirtyBegin < dirtyEnd) {
+      fseek(handle, dirtyBegin, SEEK_SET);
+      (void)fwrite(data.data() + dirtyBegin, 1, dirtyEnd - dirtyBegin, handle);
+    }
+    fclose(handle);
+  }
+  handle = nullptr;
+  data.reset();
+}
+
+//closes the file without writing back any of the image
+auto Bass::Image::discard() -> void {
+  if(!handle) return;
+  if(!stream) fclose(handle);
+  handle = nullptr;
+  data.reset();
+}
+
+//avoids reallocating the image as it grows
+auto Bass::Image::reserve(uint64_t size) -> void {
+  if(handle) data.reserve(size);
+}
+
+//seeking past the end of the file pads it with zeroes
+auto Bass::Image::seek(uint64_t offset) -> void {
+  if(!handle) return;
+  if(offset > data.size()) {
+    dirtyBegin = min(dirtyBegin, data.size());
+    dirtyEnd = offset;
+    data.resize(offset);
+  }
+  position = offset;
+}
+
+auto Bass::Image::read() -> uint8_t {
+  if(position >= data.size()) return 0;
+  return data[position++];
+}
+
+auto Bass::Image::read(array_span<uint8_t> memory) -> void {
+  uint64_t length = position < data.size() ? min(memory.size(), data.size() - position) : 0;
+  nall::memory::copy(memory.data(), data.data() + position, length);
+  nall::memory::fill(memory.data() + length, memory.size() - length);
+  position += length;
+}
+
+auto Bass::Image::write(uint8_t byte) -> void {
+  if(!handle) return;
+  if(position < data.size()) data[position] = byte;
+  else data.append(byte);
+  dirtyBegin = min(dirtyBegin, position);
+  dirtyEnd = max(dirtyEnd, ++position);
+}
+
+auto Bass::Image::write(array_view<uint8_t> memory) -> void {
+  if(!handle || !memory.size()) return;
+  uint64_t end = position + memory.size();
+  if(end > data.size()) data.resize(end);
+  nall::memory::copy(data.data() + position, memory.data(), memory.size());
+  dirtyBegin = min(dirtyBegin, position);
+  dirtyEnd = max(dirtyEnd, end);
+  position = end;
+}
+
+auto Bass::Image::fill(uint8_t byte, uint64_t length) -> void {
+  if(!handle || !length) return;
+  uint64_t end = position + length;
+  if(end > data.size()) data.resize(end);
+  nall::memory::fill(data.data() + position, length, byte);
+  dirtyBegin = min(dirtyBegin, position);
+  dirtyEnd = max(dirtyEnd, end);
+  position = end;
+}
+
+auto Bass::Image::writel(uint64_t value, uint length) -> void {
+  for(uint n : range(length)) write(uint8_t(value >> n * 8));
+}
+
+auto Bass::Image::writem(uint64_t value, uint length) -> void {
+  for(uint n : reverse(range(length))) write(uint8_t(value >> n * 8));
+}
@@ -0,0 +1,32 @@
+auto Bass::Tracker::insert(uint64_t address, uint64_t length) -> void {
+  uint64_t end = address + length;
+  while(address < end) {
+    uint64_t page = address >> 16;
+    if(page >= pages.size()) pages.resize(page + 1);
+    if(!pages[page]) pages[page].resize(1024);
+
+    uint64_t mask = ~0ull << (address & 63);
+    if(end - (address & ~63ull) < 64) mask &= ~(~0ull << (end & 63));
+    pages[page][address >> 6 & 1023] |= mask;
+    address = (address | 63) + 1;
+  }
+}
+
+//returns the first address in [address, end) that was (or was not) written, or end if there is none
+auto Bass::Tracker::next(uint64_t address, uint64_t end, bool written) const -> uint64_t {
+  while(address < end) {
+    uint64_t page = address >> 16;
+    if(page >= pages.size() || !pages[page]) {
+      if(!written) return address;
+      address = (page + 1) << 16;
+      continue;
+    }
+
+    uint64_t word = pages[page][address >> 6 & 1023];
+    if(!written) word = ~word;
+    word &= ~0ull << (address & 63);
+    if(word) return min(end, (address & ~63ull) + bit::first(word));
+    address = (address | 63) + 1;
+  }
+  return end;
+}
@@ -1,7 +1,79 @@
+//dotted names are interned as one symbol per component, so "a.b" within scope "c" is "c.a.b"
+auto Bass::internSymbol(uint scope, const string& name) -> uint {
+  if(name.find(".")) {
+    for(auto& component : name.split(".")) scope = internSymbol(scope, component);
+    return scope;
+  }
+
+  Symbol symbol{scope, name};
+  if(auto interned = symbols.find(symbol)) return interned().id;
+  symbol.id = symbolNames.size();
+  symbolNames.append(scope ? string{symbolNames[scope], ".", name} : name);
+  symbols.insert(symbol);
+  return symbol.id;
+}
+
+auto Bass::findSymbol(uint scope, const string& name) -> maybe<uint> {
+  if(name.find(".")) {
+    for(auto& component : name.split(".")) {
+      auto symbol = findSymbol(scope, component);
+      if(!symbol) return nothing;
+      scope = symbol();
+    }
+    return scope;
+  }
+
+  if(auto symbol = symbols.find({scope, name})) return symbol().id;
+  return nothing;
+}
+
+//scope holds the symbol of each enclosing scope, so that lookups never rebuild scoped names
+auto Bass::pushScope(const string& name) -> void {
+  scope.append(internSymbol(scopeSymbol(), name));
+}
+
+auto Bass::popScope() -> void {
+  scope.removeRight();
+}
+
+//returns the symbol of the active scope
+auto Bass::scopeSymbol() const -> uint {
+  return scope ? scope.right() : 0;
+}
+
+//returns the symbols of name within each enclosing scope, from the innermost scope outward.
+//names that were never declared within a scope have no symbol, so most lookups yield one at most.
+auto Bass::findSymbols(const string& name) -> const vector<uint>& {
+  symbolMatches.resize(0);
+  if(!name.find(".")) {
+    Symbol key{0, name};
+    for(uint n : reverse(range(scope.size() + 1))) {
+      key.scope = n ? scope[n - 1] : 0;
+      if(auto symbol = symbols.find(key)) symbolMatches.append(symbol().id);
+    }
+  } else {
+    for(uint n : reverse(range(scope.size() + 1))) {
+      if(auto symbol = findSymbol(n ? scope[n - 1] : 0, name)) symbolMatches.append(symbol());
+    }
+  }
+  return symbolMatches;
+}
+
+//every location searched is recorded as an input, as a file added to any of them would be selected
+auto Bass::findArchitecture(const string& name) -> const ArchitectureFiles& {
+  if(auto files = architectureFiles.find({name})) return files();
+
+  ArchitectureFiles files{name};
+  for(auto& location : Architecture::locations({name, Plugin::extension})) recordInput(location);
+  for(auto& location : Architecture::locations({name, ".arch"})) recordInput(location);
+  files.plugin = Architecture::locate({name, Plugin::extension});
+  files.table = Architecture::locate({name, ".arch"});
+  return architectureFiles.insert(files)();
+}
+
 auto Bass::setMacro(const string& name, const string_vector& parameters, uint ip, bool inlined, Frame::Level level) -> void {
   if(!validate(name)) error("invalid macro identifier: ", name);
-  string scopedName = {scope.merge("."), scope ? "." : "", name};
-  if(parameters) scopedName.append("#", parameters.size());
+  uint symbol = internSymbol(scopeSymbol(), parameters ? string{name, "#", parameters.size()} : name);
 
   for(int n : reverse(range(frames.size()))) {
     if(level != Frame::Level::Inline) {
@@ -11,12 +83,12 @@ auto Bass::setMacro(const string& name, const string_vector& parameters, uint ip
     }
 
     auto& macros = frames[n].macros;
-    if(auto macro = macros.find({scopedName})) {
+    if(auto macro = macros.find({symbol})) {
       macro().parameters = parameters;
       macro().ip = ip;
       macro().inlined = inlined;
     } else {
-      macros.insert({scopedName, parameters, ip, inlined});
+      macros.insert({symbol, parameters, ip, inlined});
     }
 
     return;
@@ -24,16 +96,15 @@ auto Bass::setMacro(const string& name, const string_vector& parameters, uint ip
 }
 
 auto Bass::findMacro(const string& name) -> maybe<Macro&> {
+  auto& matches = findSymbols(name);
+  if(!matches) return nothing;
+
   for(int n : reverse(range(frames.size()))) {
     auto& macros = frames[n].macros;
-    auto s = scope;
-    while(true) {
-      string scopedName = {s.merge("."), s ? "." : "", name};
-      if(auto macro = macros.find({scopedName})) {
+    for(auto symbol : matches) {
+      if(auto macro = macros.find({symbol})) {
         return macro();
       }
-      if(!s) break;
-      s.removeRight();
     }
   }
 
@@ -42,8 +113,7 @@ auto Bass::findMacro(const string& name) -> maybe<Macro&> {
 
 auto Bass::setDefine(const string& name, const string_vector& parameters, const string& value, Frame::Level level) -> void {
   if(!validate(name)) error("invalid define identifier: ", name);
-  string scopedName = {scope.merge("."), scope ? "." : "", name};
-  if(parameters) scopedName.append("#", parameters.size());
+  uint symbol = internSymbol(scopeSymbol(), parameters ? string{name, "#", parameters.size()} : name);
 
   for(int n : reverse(range(frames.size()))) {
     if(level != Frame::Level::Inline) {
@@ -53,11 +123,11 @@ auto Bass::setDefine(const string& name, const string_vector& parameters, const
     }
 
     auto& defines = frames[n].defines;
-    if(auto define = defines.find({scopedName})) {
+    if(auto define = defines.find({symbol})) {
       define().parameters = parameters;
       define().value = value;
     } else {
-      defines.insert({scopedName, parameters, value});
+      defines.insert({symbol, parameters, value});
     }
 
     return;
@@ -65,16 +135,15 @@ auto Bass::setDefine(const string& name, const string_vector& parameters, const
 }
 
 auto Bass::findDefine(const string& name) -> maybe<Define&> {
+  auto& matches = findSymbols(name);
+  if(!matches) return nothing;
+
   for(int n : reverse(range(frames.size()))) {
     auto& defines = frames[n].defines;
-    auto s = scope;
-    while(true) {
-      string scopedName = {s.merge("."), s ? "." : "", name};
-      if(auto define = defines.find({scopedName})) {
+    for(auto symbol : matches) {
+      if(auto define = defines.find({symbol})) {
         return define();
       }
-      if(!s) break;
-      s.removeRight();
     }
   }
 
@@ -83,8 +152,7 @@ auto Bass::findDefine(const string& name) -> maybe<Define&> {
 
 auto Bass::setExpression(const string& name, const string_vector& parameters, const string& value, Frame::Level level) -> void {
   if(!validate(name)) error("invalid expression identifier: ", name);
-  string scopedName = {scope.merge("."), scope ? "." : "", name};
-  if(parameters) scopedName.append("#", parameters.size());
+  uint symbol = internSymbol(scopeSymbol(), parameters ? string{name, "#", parameters.size()} : name);
 
   for(int n : reverse(range(frames.size()))) {
     if(level != Frame::Level::Inline) {
@@ -94,11 +162,11 @@ auto Bass::setExpression(const string& name, const string_vector& parameters, co
     }
 
     auto& expressions = frames[n].expressions;
-    if(auto expression = expressions.find({scopedName})) {
+    if(auto expression = expressions.find({symbol})) {
       expression().parameters = parameters;
       expression().value = value;
     } else {
-      expressions.insert({scopedName, parameters, value});
+      expressions.insert({symbol, parameters, value});
     }
 
     return;
@@ -106,16 +174,15 @@ auto Bass::setExpression(const string& name, const string_vector& parameters, co
 }
 
 auto Bass::findExpression(const string& name) -> maybe<Expression&> {
+  auto& matches = findSymbols(name);
+  if(!matches) return nothing;
+
   for(int n : reverse(range(frames.size()))) {
     auto& expressions = frames[n].expressions;
-    auto s = scope;
-    while(true) {
-      string scopedName = {s.merge("."), s ? "." : "", name};
-      if(auto expression = expressions.find({scopedName})) {
+    for(auto symbol : matches) {
+      if(auto expression = expressions.find({symbol})) {
         return expression();
       }
-      if(!s) break;
-      s.removeRight();
     }
   }
 
@@ -124,7 +191,7 @@ auto Bass::findExpression(const string& name) -> maybe<Expression&> {
 
 auto Bass::setVariable(const string& name, int64_t value, Frame::Level level) -> void {
   if(!validate(name)) error("invalid variable identifier: ", name);
-  string scopedName = {scope.merge("."), scope ? "." : "", name};
+  uint symbol = internSymbol(scopeSymbol(), name);
 
   for(int n : reverse(range(frames.size()))) {
     if(level != Frame::Level::Inline) {
@@ -134,10 +201,10 @@ auto Bass::setVariable(const string& name, int64_t value, Frame::Level level) ->
     }
 
     auto& variables = frames[n].variables;
-    if(auto variable = variables.find({scopedName})) {
+    if(auto variable = variables.find({symbol})) {
       variable().value = value;
     } else {
-      variables.insert({scopedName, value});
+      variables.insert({symbol, value});
     }
 
     return;
@@ -145,16 +212,15 @@ auto Bass::setVariable(const string& name, int64_t value, Frame::Level level) ->
 }
 
 auto Bass::findVariable(const string& name) -> maybe<Variable&> {
+  auto& matches = findSymbols(name);
+  if(!matches) return nothing;
+
   for(int n : reverse(range(frames.size()))) {
     auto& variables = frames[n].variables;
-    auto s = scope;
-    while(true) {
-      string scopedName = {s.merge("."), s ? "." : "", name};
-      if(auto variable = variables.find({scopedName})) {
+    for(auto symbol : matches) {
+      if(auto variable = variables.find({symbol})) {
         return variable();
       }
-      if(!s) break;
-      s.removeRight();
     }
   }
 
@@ -163,50 +229,93 @@ auto Bass::findVariable(const string& name) -> maybe<Variable&> {
 
 auto Bass::setUnknownConstant(const string& name) -> void {
   if(!validate(name)) error("invalid constant identifier: ", name);
-  string scopedName = {scope.merge("."), scope ? "." : "", name};
+  uint symbol = internSymbol(scopeSymbol(), name);
 
-  if(writePhase()) error("constant value unknown at write phase: ", scopedName);
+  if(writePhase()) error("constant value unknown at write phase: ", symbolNames[symbol]);
+  if(probedConstant(symbol)) replayable = false;
 
-  if(constantNames.find(scopedName)) error("constant cannot be modified: ", scopedName);
-  constantNames.insert(scopedName);
+  if(constantNames.find(symbol)) error("constant cannot be modified: ", symbolNames[symbol]);
+  constantNames.insert(symbol);
 }
 
 auto Bass::setConstant(const string& name, int64_t value) -> void {
   if(!validate(name)) error("invalid constant identifier: ", name);
-  string scopedName = {scope.merge("."), scope ? "." : "", name};
+  uint symbol = internSymbol(scopeSymbol(), name);
 
-  if(auto constant = constants.find({scopedName})) {
-    if(queryPhase()) error("constant cannot be modified: ", scopedName);
-    if(constant().value != value) error("constant value has changed between the query and write phases: ", scopedName);
+  if(auto constant = constants.find({symbol})) {
+    if(queryPhase()) error("constant cannot be modified: ", symbolNames[symbol]);
+    if(constant().value != value) error("constant value has changed between the query and write phases: ", symbolNames[symbol]);
   } else {
-    constantNames.insert(scopedName);
-    constants.insert({scopedName, value});
+    //an earlier lookup did not see this constant, but the write phase would
+    if(queryPhase() && probedConstant(symbol)) replayable = false;
+    if(patching) patchedConstants.append(symbol);
+    constantNames.insert(symbol);
+    constants.insert({symbol, value});
   }
 }
 
 auto Bass::findConstant(const string& name) -> maybe<Constant&> {
-  auto s = scope;
-  while(true) {
-    string scopedName = {s.merge("."), s ? "." : "", name};
-    if(auto constant = constants.find({scopedName})) {
+  //note the scopes searched before a match, as a constant declared there later would shadow it.
+  //lookups without a match are forward references, which are deferred rather than noted.
+  if(queryPhase() && replayable) {
+    for(uint n : reverse(range(scope.size() + 1))) {
+      auto symbol = findSymbol(n ? scope[n - 1] : 0, name);
+      if(!symbol) continue;
+      if(auto constant = constants.find({symbol()})) {
+        for(uint m : range(n + 1, scope.size() + 1)) probeConstant(scope[m - 1], name);
+        return constant();
+      }
+    }
+    return nothing;
+  }
+
+  for(auto symbol : findSymbols(name)) {
+    if(auto constant = constants.find({symbol})) {
       return constant();
     }
-    if(!s) break;
-    s.removeRight();
   }
 
   return nothing;
 }
 
+//notes a lookup of name within scope by the query phase, without interning it
+auto Bass::probeConstant(uint scope, const string& name) -> void {
+  if(!name.find(".")) {
+    if(auto symbol = symbols.find({scope, name})) return probedConstants.insert(symbol().id), void();
+    return probedNames.insert({scope, name}), void();
+  }
+
+  uint offset = 0;
+  for(auto& component : name.split(".")) {
+    auto symbol = symbols.find({scope, component});
+    if(!symbol) return probedNames.insert({scope, slice(name, offset)}), void();
+    scope = symbol().id;
+    offset += component.size() + 1;
+  }
+  probedConstants.insert(scope);
+}
+
+//returns true if the query phase looked up symbol before it was declared.
+//names looked up before they were interned are found from each scope enclosing the symbol.
+auto Bass::probedConstant(uint symbol) -> bool {
+  if(probedConstants.find(symbol)) return true;
+  if(!probedNames) return false;
+
+  auto& name = symbolNames[symbol];
+  uint scope = 0, offset = 0;
+  for(auto& component : name.split(".")) {
+    if(probedNames.find({scope, slice(name, offset)})) return true;
+    scope = findSymbol(scope, component)();
+    offset += component.size() + 1;
+  }
+  return false;
+}
+
 auto Bass::findConstantName(const string& name) -> maybe<string> {
-  auto s = scope;
-  while(true) {
-    string scopedName = {s.merge("."), s ? "." : "", name};
-    if(auto constant = constantNames.find({scopedName})) {
-      return constant();
+  for(auto symbol : findSymbols(name)) {
+    if(constantNames.find(symbol)) {
+      return symbolNames[symbol];
     }
-    if(!s) break;
-    s.removeRight();
   }
 
   return nothing;
@@ -214,7 +323,7 @@ auto Bass::findConstantName(const string& name) -> maybe<string> {
 
 auto Bass::setArray(const string& name, const vector<int64_t>& values, Frame::Level level) -> void {
   if(!validate(name)) error("invalid array identifier: ", name);
-  string scopedName = {scope.merge("."), scope ? "." : "", name};
+  uint symbol = internSymbol(scopeSymbol(), name);
 
   for(int n : reverse(range(frames.size()))) {
     if(level != Frame::Level::Inline) {
@@ -224,10 +333,10 @@ auto Bass::setArray(const string& name, const vector<int64_t>& values, Frame::Le
     }
 
     auto& arrays = frames[n].arrays;
-    if(auto array = arrays.find({scopedName})) {
+    if(auto array = arrays.find({symbol})) {
       array().values = values;
     } else {
-      arrays.insert({scopedName, values});
+      arrays.insert({symbol, values});
     }
 
     return;
@@ -235,61 +344,115 @@ auto Bass::setArray(const string& name, const vector<int64_t>& values, Frame::Le
 }
 
 auto Bass::findArray(const string& name) -> maybe<Array&> {
+  auto& matches = findSymbols(name);
+  if(!matches) return nothing;
+
   for(int n : reverse(range(frames.size()))) {
     auto& arrays = frames[n].arrays;
-    auto s = scope;
-    while(true) {
-      string scopedName = {s.merge("."), s ? "." : "", name};
-      if(auto array = arrays.find({scopedName})) {
+    for(auto symbol : matches) {
+      if(auto array = arrays.find({symbol})) {
         return array();
       }
-      if(!s) break;
-      s.removeRight();
     }
   }
 
   return nothing;
 }
 
+//substitutes {define} spans: each '{' pairs with the nearest '}' to its right, spans are resolved
+//from right to left, and spans naming no define are left as-is.
+//the statement is scanned once, from right to left: text left of the scan position is pending input,
+//and text right of it is output. a resolved define value is expanded by a context of its own, with
+//its parameters in scope, and the result is then returned to the pending input of the enclosing
+//context, so that it may combine with the text surrounding it.
 auto Bass::evaluateDefines(string& s) -> void {
-  for(int x = s.size() - 1, y = -1; x >= 0; x--) {
-    if(s[x] == '}') y = x;
-    if(s[x] == '{' && y > x) {
-      string name = slice(s, x + 1, y - x - 1);
-
-      if(name.match("defined ?*")) {
-        name.trimLeft("defined ", 1L).strip();
-        s = {slice(s, 0, x), findDefine(name) ? 1 : 0, slice(s, y + 1)};
-        return evaluateDefines(s);
-      }
+  if(!s.find("{")) return;
+
+  struct Context {
+    string input;         //pending text, scanned from the right
+    uint size;            //length of input not yet scanned
+    vector<char> output;  //scanned text
+    vector<uint> closes;  //output.size() after each unresolved '}' was scanned
+    bool inlined;         //a frame was appended for define parameters
+  };
+  vector<Context> contexts;
+  contexts.append({s, s.size(), {}, {}, false});
+
+  auto take = [](const vector<char>& output, uint length) -> string {
+    string result;
+    result.resize(length);
+    memory::copy(result.get(), output.data(), length);
+    return result;
+  };
 
-      string_vector parameters;
-      if(name.match("?*(*)")) {
-        auto p = name.trimRight(")", 1L).split("(", 1L).strip();
-        name = p(0);
-        parameters = split(p(1));
-      }
-      if(parameters) name.append("#", parameters.size());
-
-      if(auto define = findDefine(name)) {
-        if(parameters) frames.append({0, true});
-        for(auto n : range(parameters.size())) {
-          auto p = define().parameters(n).split(" ", 1L).strip();
-          if(p.size() == 1) p.prepend("define");
-
-          if(0);
-          else if(p[0] == "define") setDefine(p[1], {}, parameters(n), Frame::Level::Inline);
-          else if(p[0] == "string") setDefine(p[1], {}, text(parameters(n)), Frame::Level::Inline);
-          else if(p[0] == "evaluate") setDefine(p[1], {}, evaluate(parameters(n)), Frame::Level::Inline);
-          else error("unsupported parameter type: ", p[0]);
-        }
-        auto value = define().value;
-        evaluateDefines(value);
-        s = {slice(s, 0, x), value, slice(s, y + 1)};
-        if(parameters) frames.removeRight();
-        return evaluateDefines(s);
+  while(true) {
+    auto& c = contexts.right();
+
+    if(!c.size) {
+      string value = take(c.output, c.output.size());
+      if(c.inlined) frames.removeRight();
+      contexts.removeRight();
+      if(!contexts) return (void)(s = value);
+
+      auto& p = contexts.right();
+      p.input.resize(p.size);
+      p.input.append(value);
+      p.size = p.input.size();
+      continue;
+    }
+
+    char n = c.input[--c.size];
+    if(n == '}') {
+      c.output.prepend(n);
+      c.closes.append(c.output.size());
+      continue;
+    }
+    if(n != '{' || !c.closes) {
+      c.output.prepend(n);
+      continue;
+    }
+
+    uint length = c.output.size() - c.closes.right();
+    string name = take(c.output, length);
+
+    if(name.match("defined ?*")) {
+      name.trimLeft("defined ", 1L).strip();
+      c.output.removeLeft(length + 1);
+      c.closes.removeRight();
+      c.input.resize(c.size);
+      c.input.append(findDefine(name) ? 1 : 0);
+      c.size = c.input.size();
+      continue;
+    }
+
+    string_vector parameters;
+    if(name.match("?*(*)")) {
+      auto p = name.trimRight(")", 1L).split("(", 1L).strip();
+      name = p(0);
+      parameters = split(p(1));
+    }
+    if(parameters) name.append("#", parameters.size());
+
+    if(auto define = findDefine(name)) {
+      if(parameters) frames.append({0, true});
+      for(auto n : range(parameters.size())) {
+        auto p = define().parameters(n).split(" ", 1L).strip();
+        if(p.size() == 1) p.prepend("define");
+
+        if(0);
+        else if(p[0] == "define") setDefine(p[1], {}, parameters(n), Frame::Level::Inline);
+        else if(p[0] == "string") setDefine(p[1], {}, text(parameters(n)), Frame::Level::Inline);
+        else if(p[0] == "evaluate") setDefine(p[1], {}, evaluate(parameters(n)), Frame::Level::Inline);
+        else error("unsupported parameter type: ", p[0]);
       }
+      c.output.removeLeft(length + 1);
+      c.closes.removeRight();
+      auto& value = define().value;
+      contexts.append({value, value.size(), {}, {}, (bool)parameters});
+      continue;
     }
+
+    c.output.prepend(n);
   }
 }
 
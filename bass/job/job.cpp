@@ -0,0 +1,141 @@
+//takes the options of an assembly, followed by its source files.
+//returns false if any other option remains.
+auto Job::parse(Arguments& arguments) -> bool {
+  string directory;
+  arguments.take("-C", directory);
+
+  if(arguments.take("-o", targetFilename)) create = true;
+  if(arguments.take("-m", targetFilename)) create = false;
+
+  string define;
+  while(arguments.take("-d", define)) defines.append(define);
+
+  string constant;
+  while(arguments.take("-c", constant)) constants.append(constant);
+
+  arguments.take("-sym", symFilename);
+  arguments.take("-dep", depFilename);
+  strict = arguments.take("-strict");
+  benchmark = arguments.take("-benchmark");
+  arguments.take("-cache", cacheDirectory);
+
+  if(arguments.find("-*")) return false;
+  for(auto& argument : arguments) sourceFilenames.append(argument);
+  if(directory) resolve(directory);
+  return true;
+}
+
+//relative filenames are found from directory, rather than from the working directory of bass
+auto Job::resolve(const string& directory) -> void {
+  auto absolute = [&](string& filename) {
+    if(!filename || filename.beginsWith("/") || filename[1] == ':') return;
+    filename = {directory, directory.endsWith("/") ? "" : "/", filename};
+  };
+
+  absolute(targetFilename);
+  absolute(symFilename);
+  absolute(depFilename);
+  absolute(cacheDirectory);
+  for(auto& sourceFilename : sourceFilenames) absolute(sourceFilename);
+}
+
+auto Job::run() -> bool {
+  inputs.reset();
+  outputs.reset();
+
+  //a run is identified by its options and built-in architectures; the cache checks every file it read
+  maybe<Cache> cache;
+  if(cacheDirectory) {
+    cache = Cache{cacheDirectory, key()};
+    if(cache->restore(inputs, outputs)) {
+      if(benchmark) report("bass: restored from cache\n");
+      if(depFilename && !writeDependencies()) {
+        report("warning: unable to write dependency file: ", depFilename, "\n");
+      }
+      return true;
+    }
+  }
+
+  bool sideEffects = false;
+  {
+    clock_t clockStart = clock();
+    Bass bass;
+    if(diagnostic) bass.onDiagnostic(diagnostic);
+    if(sources) bass.share(*sources);
+    if(targetFilename || standardOutput) {
+      bass.target(targetFilename, create);
+    }
+    if(symFilename) {
+      bass.symFile(symFilename);
+    }
+    for(auto& sourceFilename : sourceFilenames) {
+      bass.source(sourceFilename);
+    }
+    for(auto& define : defines) {
+      auto p = define.split("=", 1L);
+      bass.define(p(0), p(1));
+    }
+    for(auto& constant : constants) {
+      auto p = constant.split("=", 1L);
+      bass.constant(p(0), p(1, "1"));
+    }
+    if(!bass.assemble(strict)) {
+      report("bass: assembly failed\n");
+      return false;
+    }
+    clock_t clockFinish = clock();
+    if(benchmark) {
+      report("bass: assembled in ", (double)(clockFinish - clockStart) / CLOCKS_PER_SEC, " seconds\n");
+    }
+    inputs = bass.inputs();
+    outputs = bass.outputs();
+    sideEffects = bass.sideEffects();
+  }  //target and symbol files are written once bass is destroyed
+
+  if(cache && !sideEffects) cache->store(inputs, outputs);
+  if(depFilename && !writeDependencies()) {
+    report("warning: unable to write dependency file: ", depFilename, "\n");
+  }
+  return true;
+}
+
+template<typename... P> auto Job::report(P&&... p) -> void {
+  string text{forward<P>(p)...};
+  if(diagnostic) return diagnostic(text);
+  print(stderr, text);
+}
+
+auto Job::key() const -> string {
+  string key = {Path::active(), "\n", create ? "-o " : "-m ", targetFilename, "\n", "-sym ", symFilename, "\n"};
+  if(strict) key.append("-strict\n");
+  for(auto& define : defines) key.append("-d ", define, "\n");
+  for(auto& constant : constants) key.append("-c ", constant, "\n");
+  for(auto& sourceFilename : sourceFilenames) key.append(sourceFilename, "\n");
+  for(auto& builtin : Native::builtins()) key.append(builtin.name, "\n", builtin.source, "\n");
+  return key;
+}
+
+//writes a make rule listing every file read by assembly as a prerequisite of every file written.
+//files that were looked for but not found are left out, as make would have no rule to create them.
+auto Job::writeDependencies() const -> bool {
+  auto escape = [](string name) -> string {
+    name.replace("$", "$$").replace(" ", "\\ ").replace("#", "\\#");
+    return name;
+  };
+
+  string_vector targets = outputs;
+  if(!targets) targets.append(depFilename);
+  string rule;
+  for(auto& target : targets) rule.append(escape(target), " ");
+  rule.trimRight(" ", 1L).append(":");
+  string_vector prerequisites;
+  for(auto& input : inputs) {
+    if(file::exists(input) && !targets.find(input)) prerequisites.append(input);
+  }
+  for(auto& prerequisite : prerequisites) rule.append(" \\\n  ", escape(prerequisite));
+  rule.append("\n");
+
+  //prerequisites are also targets without recipes, so that make does not fail once they are removed
+  for(auto& prerequisite : prerequisites) rule.append("\n", escape(prerequisite), ":\n");
+  return file::write(depFilename, rule);
+}
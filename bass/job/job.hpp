@@ -0,0 +1,32 @@
+//a single assembly, as described by the options of the command line.
+//the command line runs one job; --serve runs one per request, and --batch one per manifest entry.
+struct Job {
+  static constexpr uint StackSize = 8 * 1024 * 1024;  //of threads running jobs, as assembly recurses through includes and macros
+
+  auto parse(Arguments& arguments) -> bool;
+  auto resolve(const string& directory) -> void;
+  auto run() -> bool;
+
+  string targetFilename;
+  bool create = false;
+  string_vector defines;
+  string_vector constants;
+  string symFilename;
+  string depFilename;
+  string cacheDirectory;
+  bool strict = false;
+  bool benchmark = false;
+  string_vector sourceFilenames;
+
+  bool standardOutput = true;                 //without a target file, output is written to stdout
+  Bass::SourceCache* sources = nullptr;       //source files shared with other jobs
+  function<void (const string&)> diagnostic;  //receives diagnostics in place of stderr
+
+  string_vector inputs;   //files read by the assembly, once run
+  string_vector outputs;  //files written by the assembly, once run
+
+private:
+  template<typename... P> auto report(P&&... p) -> void;
+  auto key() const -> string;
+  auto writeDependencies() const -> bool;
+};
@@ -0,0 +1,116 @@
+#if defined(API_POSIX)
+Server::Server() {
+  settings.threadStackSize = Job::StackSize;
+}
+
+//a socket left behind by a server that is no longer running is replaced
+auto Server::open(const string& location) -> bool {
+  struct sockaddr_un address = {0};
+  address.sun_family = AF_UNIX;
+  if(!location || location.size() >= sizeof(address.sun_path)) return false;
+  memory::copy(address.sun_path, location.data(), location.size());
+
+  int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(probe < 0) return false;
+  bool running = connect(probe, (struct sockaddr*)&address, sizeof(address)) == 0;
+  ::close(probe);
+  if(running) return false;
+  struct stat data;
+  if(lstat(location, &data) == 0 && S_ISSOCK(data.st_mode)) unlink(location);
+
+  fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(fd < 0) return false;
+  if(bind(fd, (struct sockaddr*)&address, sizeof(address)) < 0) return close(), false;
+  this->location = location;
+  if(listen(fd, SOMAXCONN) < 0) return close(), false;
+  return true;
+}
+
+//accepts connections until the socket is closed. each carries one request, and its response.
+auto Server::main() -> void {
+  while(fd >= 0) {
+    int clientfd = accept(fd, nullptr, nullptr);
+    if(clientfd < 0) {
+      if(errno == EINTR || errno == ECONNABORTED) continue;
+      return;
+    }
+
+    #if defined(SO_RCVTIMEO)
+    struct timeval rcvtimeo;
+    rcvtimeo.tv_sec  = settings.timeoutReceive / 1000;
+    rcvtimeo.tv_usec = settings.timeoutReceive % 1000 * 1000;
+    setsockopt(clientfd, SOL_SOCKET, SO_RCVTIMEO, &rcvtimeo, sizeof(struct timeval));
+    #endif
+
+    #if defined(SO_SNDTIMEO)
+    struct timeval sndtimeo;
+    sndtimeo.tv_sec  = settings.timeoutSend / 1000;
+    sndtimeo.tv_usec = settings.timeoutSend % 1000 * 1000;
+    setsockopt(clientfd, SOL_SOCKET, SO_SNDTIMEO, &sndtimeo, sizeof(struct timeval));
+    #endif
+
+    if(connections >= settings.connectionLimit) {
+      upload(clientfd, HTTP::Response().setResponseType(503));
+      ::close(clientfd);
+      continue;
+    }
+
+    ++connections;
+    thread::create([this, clientfd](uintptr) {
+      thread::detach();
+
+      HTTP::Request request;
+      if(download(clientfd, request)) {
+        upload(clientfd, respond(request));
+      } else {
+        upload(clientfd, HTTP::Response().setResponseType(400));
+      }
+
+      ::close(clientfd);
+      --connections;
+    }, 0, settings.threadStackSize);
+  }
+}
+
+auto Server::close() -> void {
+  if(fd >= 0) ::close(fd);
+  fd = -1;
+  if(location) unlink(location);
+  location = {};
+}
+
+//requests are posted to /assemble. the body lists the arguments of one assembly, one per line,
+//as they would be given on the command line. the response body holds the diagnostics raised by
+//assembly, followed by its result; its headers list the result, and every file it wrote.
+auto Server::respond(const HTTP::Request& request) -> HTTP::Response {
+  HTTP::Response response(request);
+  response.header.append("Content-Type", "text/plain; charset=utf-8");
+  if(request.requestType() != HTTP::Request::RequestType::Post || request.path() != "/assemble") {
+    return response.setResponseType(404);
+  }
+
+  string_vector arguments{"bass-untech"};
+  for(auto& line : request._body.split("\n")) {
+    line.trimRight("\r", 1L);
+    if(line) arguments.append(line);
+  }
+
+  Job job;
+  Arguments parameters{arguments};
+  if(!job.parse(parameters) || !job.sourceFilenames) {
+    return response.setResponseType(400).setText("error: unrecognized argument(s)\n");
+  }
+
+  //requests share source files, but each collects its own diagnostics
+  string diagnostics;
+  job.standardOutput = false;
+  job.sources = &sources;
+  job.diagnostic = [&](const string& text) { diagnostics.append(text); };
+  bool assembled = job.run();
+  if(assembled) diagnostics.append("bass: assembled\n");  //failures are already reported by the job
+
+  response.header.append("Bass-Result", assembled ? "assembled" : "failed");
+  for(auto& output : job.outputs) response.header.append("Output", output);
+  return response.setResponseType(200).setText(diagnostics);
+}
+#endif
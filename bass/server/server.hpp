@@ -0,0 +1,19 @@
+#if defined(API_POSIX)
+//assembles jobs received over a Unix socket, with --serve.
+//source files and architectures stay loaded between requests, which each run on their own thread.
+struct Server : HTTP::Role {
+  Server();
+  ~Server() { close(); }
+  auto open(const string& location) -> bool;
+  auto main() -> void;
+  auto close() -> void;
+
+private:
+  auto respond(const HTTP::Request& request) -> HTTP::Response;
+
+  string location;  //path of the socket, once bound
+  int fd = -1;
+  std::atomic<int> connections{0};
+  Bass::SourceCache sources;
+};
+#endif
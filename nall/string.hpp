@@ -353,6 +353,7 @@ inline auto operator"" _s(const char* value, std::size_t) -> string { return {va
 #include <nall/string/vector.hpp>
 
 #include <nall/string/eval/node.hpp>
+#include <nall/string/eval/pool.hpp>
 #include <nall/string/eval/literal.hpp>
 #include <nall/string/eval/parser.hpp>
 #include <nall/string/eval/evaluator.hpp>
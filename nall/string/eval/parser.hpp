@@ -29,47 +29,51 @@ inline auto whitespace(char n) -> bool {
 //  a<<<b a>>>b a<<<=b a>>>=b rotation operators were added
 //  a~b a~=b concatenation operators were added
 //  a??b coalesce operator was added
-inline auto parse(Node*& node, const char*& s, uint depth) -> void {
+inline auto parse(Node*& node, const char*& s, uint depth, Pool* pool = nullptr) -> void {
+  auto create = [&](Node::Type type = Node::Type::Null) -> Node* {
+    return pool ? pool->allocate(type) : new Node(type);
+  };
+
   auto unaryPrefix = [&](Node::Type type, uint seek, uint depth) {
-    auto parent = new Node(type);
-    parse(parent->link(0) = new Node, s += seek, depth);
+    auto parent = create(type);
+    parse(parent->link(0) = create(), s += seek, depth, pool);
     node = parent;
   };
 
   auto unarySuffix = [&](Node::Type type, uint seek, uint depth) {
-    auto parent = new Node(type);
+    auto parent = create(type);
     parent->link(0) = node;
-    parse(parent, s += seek, depth);
+    parse(parent, s += seek, depth, pool);
     node = parent;
   };
 
   auto binary = [&](Node::Type type, uint seek, uint depth) {
-    auto parent = new Node(type);
+    auto parent = create(type);
     parent->link(0) = node;
-    parse(parent->link(1) = new Node, s += seek, depth);
+    parse(parent->link(1) = create(), s += seek, depth, pool);
     node = parent;
   };
 
   auto ternary = [&](Node::Type type, uint seek, uint depth) {
-    auto parent = new Node(type);
+    auto parent = create(type);
     parent->link(0) = node;
-    parse(parent->link(1) = new Node, s += seek, depth);
+    parse(parent->link(1) = create(), s += seek, depth, pool);
     if(s[0] != ':') throw "mismatched ternary";
-    parse(parent->link(2) = new Node, s += seek, depth);
+    parse(parent->link(2) = create(), s += seek, depth, pool);
     node = parent;
   };
 
   auto separator = [&](Node::Type type, uint seek, uint depth) {
     if(node->type != Node::Type::Separator) return binary(type, seek, depth);
     uint n = node->link.size();
-    parse(node->link(n) = new Node, s += seek, depth);
+    parse(node->link(n) = create(), s += seek, depth, pool);
   };
 
   while(whitespace(s[0])) s++;
   if(!s[0]) return;
 
   if(s[0] == '(' && !node->link) {
-    parse(node, s += 1, 1);
+    parse(node, s += 1, 1, pool);
     if(*s++ != ')') throw "mismatched group";
   }
 
@@ -192,4 +196,11 @@ inline auto parse(const string& expression) -> Node* {
   return result;
 }
 
+inline auto parse(const string& expression, Pool& pool) -> Node* {
+  auto result = pool.allocate();
+  const char* p = expression;
+  parse(result, p, 0, &pool);
+  return result;
+}
+
 }
@@ -0,0 +1,43 @@
+#pragma once
+
+namespace nall::Eval {
+
+//allocates nodes from contiguous blocks, so that entire trees can be released at once
+//links between pooled nodes are owned by the pool rather than by their parent nodes
+struct Pool {
+  Pool() = default;
+  Pool(const Pool&) = delete;
+  auto operator=(const Pool&) -> Pool& = delete;
+
+  ~Pool() {
+    reset();
+    for(auto block : blocks) ::operator delete(block);
+  }
+
+  auto size() const -> uint { return count; }
+
+  auto allocate(Node::Type type = Node::Type::Null) -> Node* {
+    if(count == blocks.size() * BlockSize) blocks.append((Node*)::operator new(sizeof(Node) * BlockSize));
+    auto node = blocks[count / BlockSize] + count % BlockSize;
+    count++;
+    return new(node) Node(type);
+  }
+
+  //destroys all nodes, but retains the allocated blocks for reuse
+  auto reset() -> void {
+    for(uint n : range(count)) {
+      auto& node = blocks[n / BlockSize][n % BlockSize];
+      node.link.reset();
+      node.~Node();
+    }
+    count = 0;
+  }
+
+private:
+  static constexpr uint BlockSize = 256;
+
+  vector<Node*> blocks;
+  uint count = 0;
+};
+
+}